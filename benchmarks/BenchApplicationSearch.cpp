@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ApplicationIndex.h"
+#include "InstallationFinder.h"
+#include "KeywordMatcher.h"
+
+namespace {
+    // The matching of InstallationFinder::findApplication before the query was compiled once
+    bool matchPerApplication(const std::string &query, const std::string &name) {
+        std::string lowerQuery = query;
+        std::ranges::transform(lowerQuery, lowerQuery.begin(), tolower);
+        std::istringstream stream(lowerQuery);
+        std::vector<std::string> keywords;
+        std::string keyword;
+        while (stream >> keyword) {
+            keywords.push_back(keyword);
+        }
+        std::string lowerName = name;
+        std::ranges::transform(lowerName, lowerName.begin(), tolower);
+        return std::ranges::all_of(keywords, [&](const std::string &k) { return lowerName.find(k) != std::string::npos; });
+    }
+
+    template<typename Search>
+    void measure(const char *label, const int rounds, Search search) {
+        size_t found = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            found = search();
+        }
+        const auto duration = std::chrono::steady_clock::now() - start;
+        std::cout << label << ": " << found << " matches, "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / rounds << " us per search"
+                  << std::endl;
+    }
+} // namespace
+
+// Compares the ways of searching the names of 50000 synthetic packages for "dosbox staging"
+int main() {
+    constexpr int packageCount = 50000;
+    constexpr int rounds = 20;
+    const std::string query = "DOSBox Staging";
+    const char *prefixes[] = {"lib", "python3-", "gir1.2-", "fonts-", "node-", "golang-", "texlive-", ""};
+
+    std::vector<DosboxStagingReplacer::InstallationInfo> applications;
+    for (int i = 0; i < packageCount; ++i) {
+        applications.push_back({std::string(prefixes[i % 8]) + "package" + std::to_string(i) + "-common", "", "apt"});
+    }
+    applications.push_back({"dosbox-staging", "/usr/bin/dosbox-staging", "apt"});
+    applications.push_back({"io.github.dosbox-staging", "/var/lib/flatpak/app", "flatpak"});
+
+    measure("Per application", rounds, [&] {
+        return std::ranges::count_if(applications, [&](const auto &app) {
+            return matchPerApplication(query, app.applicationName);
+        });
+    });
+    measure("KeywordMatcher", rounds, [&] {
+        const DosboxStagingReplacer::KeywordMatcher matcher(query);
+        return std::ranges::count_if(applications, [&](const auto &app) {
+            return matcher.matches(app.applicationName);
+        });
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    const DosboxStagingReplacer::ApplicationIndex index(applications);
+    const auto duration = std::chrono::steady_clock::now() - start;
+    std::cout << "ApplicationIndex built in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms" << std::endl;
+    measure("ApplicationIndex", rounds, [&] { return index.find(query).size(); });
+    return 0;
+}
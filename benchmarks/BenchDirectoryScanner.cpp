@@ -0,0 +1,48 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "DirectoryScanner.h"
+
+// Scans a synthetic directory of 100k entries with every DirectoryScanner backend, with and without sizes.
+// The tree is created under the temporary directory on the first run and reused afterwards, pass --cleanup
+// to remove it once done.
+int main(int argc, char *argv[]) {
+    constexpr int entryCount = 100000;
+    const auto root = std::filesystem::temp_directory_path() / "BenchDirectoryScanner";
+
+    if (!std::filesystem::exists(root / "complete")) {
+        std::cout << "Creating " << entryCount << " entries in " << root << std::endl;
+        std::filesystem::create_directories(root);
+        for (int i = 0; i < entryCount; ++i) {
+            // One entry in ten is a directory so both d_type paths are exercised
+            const auto entry = root / ("entry_" + std::to_string(i));
+            if (i % 10 == 0) {
+                std::filesystem::create_directory(entry);
+            } else {
+                std::ofstream(entry) << i;
+            }
+        }
+        std::ofstream(root / "complete");
+    }
+
+    using DosboxStagingReplacer::ScanBackend;
+    for (const auto &[backendName, backend]: {std::pair{"portable", ScanBackend::Portable},
+                                              std::pair{"getdents", ScanBackend::Getdents}}) {
+        for (const bool readSizes: {true, false}) {
+            const auto start = std::chrono::steady_clock::now();
+            const auto files = DosboxStagingReplacer::DirectoryScanner::scanDirectory(
+                    root.string(), {.backend = backend, .readSizes = readSizes});
+            const auto duration = std::chrono::steady_clock::now() - start;
+            std::cout << backendName << (readSizes ? " with sizes: " : " without sizes: ") << files.size()
+                      << " entries, " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()
+                      << " ms" << std::endl;
+        }
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--cleanup") {
+        std::filesystem::remove_all(root);
+    }
+    return 0;
+}
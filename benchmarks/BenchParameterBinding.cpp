@@ -0,0 +1,48 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "SqlService.h"
+#include "StatementParser.h"
+
+// Compares the per-query overhead of binding parameters through the named std::any map
+// against the positional SqlParameter list, using the same cached statement for both.
+int main() {
+    constexpr int iterations = 200000;
+    DosboxStagingReplacer::SqlLiteService sqlService(":memory:");
+    sqlService.executeQuery(R"SQL(
+        CREATE TABLE PlayTasks (id INTEGER PRIMARY KEY, gameReleaseKey TEXT, userId INT64, "order" INTEGER)
+    )SQL", {});
+    sqlService.executeQuery("INSERT INTO PlayTasks (gameReleaseKey, userId, \"order\") VALUES ('gog_1', 1, 1);", {});
+
+    const std::string query = R"SQL(
+        SELECT id FROM PlayTasks WHERE gameReleaseKey = :gameReleaseKey AND userId = :userId AND "order" = :order;
+    )SQL";
+    const std::string gameReleaseKey = "gog_1";
+    constexpr int64_t userId = 1;
+    constexpr int order = 1;
+
+    size_t rows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        rows += sqlService
+                        .executeQuery<DosboxStagingReplacer::SqliteLastRowId>(
+                                query, {{"gameReleaseKey", gameReleaseKey}, {"userId", userId}, {"order", order}})
+                        .size();
+    }
+    const auto mapDuration = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        rows += sqlService.executeQuery<DosboxStagingReplacer::SqliteLastRowId>(query, {gameReleaseKey, userId, order})
+                        .size();
+    }
+    const auto positionalDuration = std::chrono::steady_clock::now() - start;
+
+    const auto mapNs = std::chrono::duration_cast<std::chrono::nanoseconds>(mapDuration).count() / iterations;
+    const auto positionalNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(positionalDuration).count() / iterations;
+    std::cout << "Rows read: " << rows << std::endl;
+    std::cout << "Named std::any map binding: " << mapNs << " ns/query" << std::endl;
+    std::cout << "Positional SqlParameter binding: " << positionalNs << " ns/query" << std::endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "SqlService.h"
+#include "StatementParser.h"
+
+// Counts every heap allocation made by the process so the allocations per decoded row can be reported
+static std::atomic<size_t> allocationCount = 0;
+
+void *operator new(const std::size_t size) {
+    allocationCount++;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+// Decodes a synthetic 50k row PlayTasks table through SqlLiteService::executeQuery and reports the
+// heap allocations per row. Release keys and types fit in the small string buffer, so any allocation
+// left per row comes from the materialization path itself.
+int main() {
+    constexpr int rowCount = 50000;
+    DosboxStagingReplacer::SqlLiteService sqlService(":memory:");
+    sqlService.executeQuery(R"SQL(
+        CREATE TABLE PlayTaskTypes (id INTEGER PRIMARY KEY, type TEXT NOT NULL)
+    )SQL", {});
+    sqlService.executeQuery(R"SQL(
+        CREATE TABLE PlayTasks (
+            id INTEGER PRIMARY KEY, gameReleaseKey TEXT, userId INT64, "order" INTEGER, typeId INTEGER,
+            isPrimary BOOLEAN
+        )
+    )SQL", {});
+    sqlService.executeQuery("INSERT INTO PlayTaskTypes (id, type) VALUES (1, 'Custom');", {});
+
+    sqlService.beginTransaction();
+    for (int i = 0; i < rowCount; ++i) {
+        const std::string gameReleaseKey = "gog_" + std::to_string(i);
+        sqlService.executeQuery(R"SQL(
+            INSERT INTO PlayTasks (gameReleaseKey, userId, "order", typeId, isPrimary)
+            VALUES (:gameReleaseKey, :userId, :order, 1, :isPrimary);
+        )SQL", {gameReleaseKey, i % 4, i, i % 2 == 0});
+    }
+    sqlService.commitTransaction();
+
+    const std::string query = R"SQL(
+        SELECT
+            pt.id, pt.gameReleaseKey, pt.userId, pt."order", pt.typeId, ptt.type, pt.isPrimary
+        FROM PlayTasks pt
+        INNER JOIN PlayTaskTypes ptt ON pt.typeId = ptt.id;
+    )SQL";
+
+    // The first run has no row count hint yet, the second one reuses the cached statement and its hint
+    for (const auto *run: {"cold", "warm"}) {
+        const size_t allocationsBefore = allocationCount;
+        const auto start = std::chrono::steady_clock::now();
+        const auto playTasks = sqlService.executeQuery<DosboxStagingReplacer::PlayTaskInformation>(query, {});
+        const auto duration = std::chrono::steady_clock::now() - start;
+        const size_t allocations = allocationCount - allocationsBefore;
+
+        std::cout << run << ": " << playTasks.size() << " rows, " << allocations << " allocations ("
+                  << static_cast<double>(allocations) / static_cast<double>(playTasks.size()) << " per row), "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() << " us" << std::endl;
+    }
+
+    // Same rows read as views into an arena owned by the result set, text no longer depends on the small
+    // string buffer so only the row vector and the arena blocks are allocated
+    const size_t allocationsBefore = allocationCount;
+    const auto start = std::chrono::steady_clock::now();
+    const auto playTaskViews = sqlService.executeQueryView<DosboxStagingReplacer::PlayTaskInformationView>(query, {});
+    const auto duration = std::chrono::steady_clock::now() - start;
+    const size_t allocations = allocationCount - allocationsBefore;
+
+    std::cout << "arena: " << playTaskViews.size() << " rows, " << allocations << " allocations ("
+              << playTaskViews.getArena().getBlockCount() << " arena blocks), "
+              << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() << " us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "DirectoryScanner.h"
+
+namespace {
+    // Heap bytes held by a string, 0 while it fits in the small string buffer
+    size_t heapBytes(const std::string &text) {
+        return text.capacity() > std::string().capacity() ? text.capacity() + 1 : 0;
+    }
+} // namespace
+
+// Compares the memory held by scanRecursive and scanRecursiveCompact for a synthetic game library of
+// 200 games with 500 files each. The tree is created under the temporary directory on the first run and
+// reused afterwards, pass --cleanup to remove it once done.
+int main(int argc, char *argv[]) {
+    constexpr int gameCount = 200;
+    constexpr int filesPerGame = 500;
+    const auto root = std::filesystem::temp_directory_path() / "BenchScanMemory";
+
+    if (!std::filesystem::exists(root / "complete")) {
+        std::cout << "Creating " << gameCount * filesPerGame << " entries in " << root << std::endl;
+        for (int game = 0; game < gameCount; ++game) {
+            const auto gameDirectory = root / ("Game Title Number " + std::to_string(game)) / "DATA";
+            std::filesystem::create_directories(gameDirectory);
+            for (int i = 0; i < filesPerGame; ++i) {
+                std::ofstream(gameDirectory / ("FILE" + std::to_string(i) + ".DAT"));
+            }
+        }
+        std::ofstream(root / "complete");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto files = DosboxStagingReplacer::DirectoryScanner::scanRecursive(root.string());
+    auto duration = std::chrono::steady_clock::now() - start;
+    size_t entityBytes = files.capacity() * sizeof(DosboxStagingReplacer::FileEntity);
+    for (const auto &file: files) {
+        entityBytes += heapBytes(file.name) + heapBytes(file.path);
+    }
+    std::cout << "FileEntity: " << files.size() << " entries, " << entityBytes << " bytes, "
+              << entityBytes / files.size() << " bytes per entry, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    const auto compact = DosboxStagingReplacer::DirectoryScanner::scanRecursiveCompact(root.string());
+    duration = std::chrono::steady_clock::now() - start;
+    const auto compactBytes = compact.getMemoryUsage();
+    std::cout << "ScanResult: " << compact.size() << " entries, " << compactBytes << " bytes, "
+              << compactBytes / compact.size() << " bytes per entry, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms" << std::endl;
+
+    if (argc > 1 && std::string(argv[1]) == "--cleanup") {
+        std::filesystem::remove_all(root);
+    }
+    return 0;
+}
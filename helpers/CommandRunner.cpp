@@ -0,0 +1,255 @@
+#include "CommandRunner.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+#endif
+
+namespace DosboxStagingReplacer {
+
+    namespace {
+        /**
+         * @brief Buffer the output is read into, passing on every line once its line break arrived.
+         */
+        class LineReader {
+        public:
+            LineReader(const size_t readSize, const CommandRunner::LineCallback &onLine) :
+                buffer(std::max<size_t>(readSize, 1)), onLine(onLine) {}
+
+            /**
+             * @brief Returns the free space of the buffer, the buffer grows when a single line fills it.
+             */
+            std::span<char> space() {
+                if (this->used == this->buffer.size()) {
+                    this->buffer.resize(this->buffer.size() * 2);
+                }
+                return {this->buffer.data() + this->used, this->buffer.size() - this->used};
+            }
+
+            /**
+             * @brief Passes on the lines completed by bytes just read into the space.
+             */
+            void commit(const size_t count) {
+                // Only the new bytes can hold line breaks, the partial line before them was already searched
+                size_t searched = this->used;
+                this->used += count;
+                size_t start = 0;
+                while (const auto *found = static_cast<const char *>(
+                               std::memchr(this->buffer.data() + searched, '\n', this->used - searched))) {
+                    const auto end = static_cast<size_t>(found - this->buffer.data());
+                    this->onLine(std::string_view(this->buffer.data() + start, end - start));
+                    start = end + 1;
+                    searched = start;
+                }
+                if (start > 0) {
+                    std::memmove(this->buffer.data(), this->buffer.data() + start, this->used - start);
+                    this->used -= start;
+                }
+            }
+
+            /**
+             * @brief Passes on the last line when the output does not end with a line break.
+             */
+            void finish() {
+                if (this->used > 0) {
+                    this->onLine(std::string_view(this->buffer.data(), this->used));
+                    this->used = 0;
+                }
+            }
+
+        private:
+            std::vector<char> buffer;
+            size_t used = 0;
+            const CommandRunner::LineCallback &onLine;
+        };
+    } // namespace
+
+#ifdef _WIN32
+
+    CommandResult CommandRunner::run(const std::vector<std::string> &arguments, const LineCallback &onLine,
+                                     const CommandOptions &options) {
+        if (arguments.empty()) {
+            throw std::runtime_error("No command to run");
+        }
+        // There is no posix_spawn, the command goes through the shell and cannot be timed out or stopped
+        std::string command;
+        for (const auto &argument: arguments) {
+            command += (command.empty() ? "\"" : " \"") + argument + "\"";
+        }
+        if (options.discardErrors) {
+            command += " 2>NUL";
+        }
+        // cmd.exe strips the first and the last quote of a command line that starts with one, so the whole line is
+        // quoted once more to keep the quotes of the arguments
+        command = "\"" + command + "\"";
+        FILE *pipe = _popen(command.c_str(), "r");
+        if (pipe == nullptr) {
+            throw std::runtime_error("Could not start " + arguments.front());
+        }
+        LineReader reader(options.readSize, onLine);
+        CommandResult result;
+        try {
+            while (true) {
+                const auto space = reader.space();
+                const auto count = std::fread(space.data(), 1, space.size(), pipe);
+                if (count == 0) {
+                    break;
+                }
+                reader.commit(count);
+            }
+            reader.finish();
+        } catch (...) {
+            _pclose(pipe);
+            throw;
+        }
+        result.exitCode = _pclose(pipe);
+        return result;
+    }
+
+#else
+
+    CommandResult CommandRunner::run(const std::vector<std::string> &arguments, const LineCallback &onLine,
+                                     const CommandOptions &options) {
+        using Clock = std::chrono::steady_clock;
+        if (arguments.empty()) {
+            throw std::runtime_error("No command to run");
+        }
+
+        int output[2];
+        if (pipe2(output, O_CLOEXEC) != 0) {
+            throw std::runtime_error(std::string("Could not create a pipe: ") + std::strerror(errno));
+        }
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        // dup2 clears close on exec on the copy, the child keeps only its standard streams
+        posix_spawn_file_actions_adddup2(&actions, output[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+        if (options.discardErrors) {
+            posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+        }
+        std::vector<char *> argv;
+        argv.reserve(arguments.size() + 1);
+        for (const auto &argument: arguments) {
+            argv.push_back(const_cast<char *>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        pid_t pid = 0;
+        const int error = posix_spawnp(&pid, argv.front(), &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        close(output[1]);
+        if (error != 0) {
+            close(output[0]);
+            throw std::runtime_error("Could not start " + arguments.front() + ": " + std::strerror(error));
+        }
+
+        CommandResult result;
+        const auto deadline = options.timeout.count() > 0 ? Clock::now() + options.timeout : Clock::time_point::max();
+        // Without a timeout or a stop token nothing but the output can end the wait
+        const bool waitForOutput = options.timeout.count() <= 0 && !options.stop.stop_possible();
+        LineReader reader(options.readSize, onLine);
+        const auto endChild = [&](bool kill) {
+            close(output[0]);
+            int status = 0;
+            // The output can end before the command does, it is given what is left of the timeout to exit
+            for (auto wait = std::chrono::milliseconds(1); !kill && !waitForOutput;
+                 wait = std::min(wait * 2, std::chrono::milliseconds(50))) {
+                const pid_t exited = waitpid(pid, &status, WNOHANG);
+                if (exited == pid) {
+                    result.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+                    return;
+                }
+                if (exited < 0 && errno != EINTR) {
+                    return;
+                }
+                if (options.stop.stop_requested()) {
+                    result.stopped = kill = true;
+                } else if (const auto now = Clock::now(); now >= deadline) {
+                    result.timedOut = kill = true;
+                } else if (exited == 0) {
+                    std::this_thread::sleep_for(std::min<Clock::duration>(wait, deadline - now));
+                }
+            }
+            if (kill) {
+                ::kill(pid, SIGKILL);
+            }
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+            }
+            result.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        };
+
+        try {
+            while (true) {
+                if (options.stop.stop_requested()) {
+                    result.stopped = true;
+                    break;
+                }
+                const auto now = Clock::now();
+                if (now >= deadline) {
+                    result.timedOut = true;
+                    break;
+                }
+                // Woken up regularly to notice a stop request
+                auto wait = std::chrono::milliseconds(50);
+                if (deadline != Clock::time_point::max()) {
+                    wait = std::min(wait, std::chrono::ceil<std::chrono::milliseconds>(deadline - now));
+                }
+                pollfd descriptor{output[0], POLLIN, 0};
+                const int ready = poll(&descriptor, 1, waitForOutput ? -1 : static_cast<int>(wait.count()));
+                if (ready == 0 || (ready < 0 && errno == EINTR)) {
+                    continue;
+                }
+                const auto space = reader.space();
+                const auto count = ready > 0 ? read(output[0], space.data(), space.size()) : -1;
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count <= 0) {
+                    // End of the output, a read error leaves the rest of the output unread as well
+                    reader.finish();
+                    break;
+                }
+                reader.commit(static_cast<size_t>(count));
+            }
+        } catch (...) {
+            endChild(true);
+            throw;
+        }
+        endChild(result.stopped || result.timedOut);
+        return result;
+    }
+
+#endif
+
+    size_t CommandRunner::splitFields(std::string_view line, const std::span<std::string_view> fields,
+                                      const char separator) {
+        if (fields.empty()) {
+            return 0;
+        }
+        size_t count = 0;
+        while (count + 1 < fields.size()) {
+            const auto end = line.find(separator);
+            if (end == std::string_view::npos) {
+                break;
+            }
+            fields[count++] = line.substr(0, end);
+            line.remove_prefix(end + 1);
+        }
+        fields[count++] = line;
+        return count;
+    }
+
+} // namespace DosboxStagingReplacer
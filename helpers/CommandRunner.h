@@ -0,0 +1,75 @@
+#ifndef COMMANDRUNNER_H
+#define COMMANDRUNNER_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Options of CommandRunner::run.
+     */
+    struct CommandOptions {
+        /// The command is killed once it runs longer, 0 waits as long as it takes
+        std::chrono::milliseconds timeout{0};
+        /// The command is killed once a stop is requested
+        std::stop_token stop;
+        /// Bytes read from the output at once, a longer line grows the buffer
+        size_t readSize = 64 * 1024;
+        /// If false, the errors of the command are written to the error output of this process
+        bool discardErrors = true;
+    };
+
+    /**
+     * @brief How a command ended.
+     */
+    struct CommandResult {
+        /// The exit code, -1 if the command was killed by a signal
+        int exitCode = -1;
+        bool timedOut = false;
+        bool stopped = false;
+
+        [[nodiscard]] bool succeeded() const { return this->exitCode == 0 && !this->timedOut && !this->stopped; }
+    };
+
+    /**
+     * @brief Runs commands without a shell and hands their output over line by line.
+     *
+     * The output is read in large chunks into a single buffer and every line is passed to the callback as a view
+     * of that buffer, so the output is never copied into a string of its own.
+     */
+    class CommandRunner {
+    public:
+        /// Receives each line without its line break, the view is only valid during the call
+        using LineCallback = std::function<void(std::string_view line)>;
+
+        /**
+         * @brief Runs a command and waits for it to end.
+         * @param arguments The program, looked up in the PATH, followed by its arguments.
+         * @param onLine Called for each line of the standard output, including a last line without a line break.
+         * @param options The timeout, stop token and buffer size.
+         * @return How the command ended.
+         * @throws std::runtime_error If the command could not be started.
+         */
+        static CommandResult run(const std::vector<std::string> &arguments, const LineCallback &onLine,
+                                 const CommandOptions &options = {});
+
+        /**
+         * @brief Splits a record into fields, without copying them.
+         * @param line The record, e.g. a line passed to a LineCallback.
+         * @param fields Receives views of the fields, fields past its size are left in the last one.
+         * @param separator The field separator.
+         * @return The number of fields written.
+         */
+        static size_t splitFields(std::string_view line, std::span<std::string_view> fields, char separator = '\t');
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // COMMANDRUNNER_H
@@ -0,0 +1,129 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace DosboxStagingReplacer {
+
+    namespace {
+        // Lets submit find the queue of the worker it is called from
+        thread_local const WorkStealingPool *currentPool = nullptr;
+        thread_local unsigned int currentWorker = 0;
+    } // namespace
+
+    WorkStealingPool::WorkStealingPool(const unsigned int workers) :
+        workerCount(workers != 0 ? workers : std::max(1u, std::thread::hardware_concurrency())) {
+        for (unsigned int i = 0; i < this->workerCount; ++i) {
+            this->queues.push_back(std::make_unique<WorkerQueue>());
+        }
+    }
+
+    unsigned int WorkStealingPool::getWorkerCount() const {
+        return this->workerCount;
+    }
+
+    void WorkStealingPool::submit(Task task) {
+        const unsigned int worker = currentPool == this ? currentWorker : 0;
+        this->pending++;
+        {
+            std::lock_guard lock(this->queues[worker]->mutex);
+            this->queues[worker]->tasks.push_back(std::move(task));
+            this->queued++;
+        }
+        // Only a sleeping worker needs waking. Taking the idle mutex orders the new task before the check of a
+        // worker that is about to sleep
+        if (this->sleeping != 0) {
+            { std::lock_guard lock(this->idleMutex); }
+            this->idle.notify_one();
+        }
+    }
+
+    bool WorkStealingPool::takeTask(const unsigned int worker, Task &task) {
+        // Own queue first, newest task first
+        {
+            auto &queue = *this->queues[worker];
+            std::lock_guard lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                this->queued--;
+                return true;
+            }
+        }
+        // Then steal the oldest task of the other workers
+        for (unsigned int offset = 1; offset < this->workerCount; ++offset) {
+            auto &queue = *this->queues[(worker + offset) % this->workerCount];
+            std::lock_guard lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                this->queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::work(const unsigned int worker) {
+        const auto *previousPool = currentPool;
+        const auto previousWorker = currentWorker;
+        currentPool = this;
+        currentWorker = worker;
+
+        Task task;
+        while (this->pending != 0) {
+            if (!this->takeTask(worker, task)) {
+                // Another worker is still running a task that may submit more, sleep until it does or all are done
+                std::unique_lock lock(this->idleMutex);
+                this->sleeping++;
+                this->idle.wait(lock, [this] { return this->queued != 0 || this->pending == 0; });
+                this->sleeping--;
+                continue;
+            }
+
+            if (!this->failed) {
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard lock(this->idleMutex);
+                    if (!this->failed.exchange(true)) {
+                        this->failure = std::current_exception();
+                    }
+                }
+            }
+            task = nullptr;
+
+            if (--this->pending == 0) {
+                { std::lock_guard lock(this->idleMutex); }
+                this->idle.notify_all();
+            }
+        }
+
+        currentPool = previousPool;
+        currentWorker = previousWorker;
+    }
+
+    void WorkStealingPool::run(Task root) {
+        this->failed = false;
+        this->failure = nullptr;
+        this->pending = 1;
+        {
+            std::lock_guard lock(this->queues[0]->mutex);
+            this->queues[0]->tasks.push_back(std::move(root));
+            this->queued = 1;
+        }
+
+        {
+            std::vector<std::jthread> workers;
+            for (unsigned int worker = 1; worker < this->workerCount; ++worker) {
+                workers.emplace_back([this, worker] { this->work(worker); });
+            }
+            this->work(0);
+        }
+
+        if (this->failure) {
+            std::rethrow_exception(this->failure);
+        }
+    }
+
+} // namespace DosboxStagingReplacer
@@ -0,0 +1,74 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Thread pool for tasks that spawn more tasks, such as walking a directory tree.
+     *
+     * Every worker owns a queue, tasks submitted from a worker go to its own queue and are taken back
+     * newest first, which keeps a worker on the subtree it is already walking. A worker that runs out of
+     * tasks steals the oldest task of another worker, so large subtrees get split between idle workers.
+     */
+    class WorkStealingPool {
+    public:
+        using Task = std::function<void()>;
+
+        /**
+         * @brief Constructs the pool, no thread is started until run is called.
+         * @param workers The number of workers, 0 uses one per hardware thread.
+         */
+        explicit WorkStealingPool(unsigned int workers = 0);
+
+        /**
+         * @brief Runs a task and every task it submits, returns once all of them are finished.
+         * The calling thread takes part as one of the workers. If a task throws, tasks that did not
+         * start yet are skipped and the first exception is rethrown.
+         * @param root The first task.
+         */
+        void run(Task root);
+
+        /**
+         * @brief Queues a task, meant to be called from a task that is being run.
+         * @param task The task to queue.
+         */
+        void submit(Task task);
+
+        /**
+         * @brief Returns the number of workers used by run.
+         */
+        [[nodiscard]] unsigned int getWorkerCount() const;
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        unsigned int workerCount;
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        // Tasks queued or running, tasks queued only, and workers waiting for a task
+        std::atomic<size_t> pending = 0;
+        std::atomic<size_t> queued = 0;
+        std::atomic<unsigned int> sleeping = 0;
+        std::atomic<bool> failed = false;
+        std::exception_ptr failure;
+        std::mutex idleMutex;
+        std::condition_variable idle;
+
+        bool takeTask(unsigned int worker, Task &task);
+        void work(unsigned int worker);
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // WORKSTEALINGPOOL_H
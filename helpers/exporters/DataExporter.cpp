@@ -3,201 +3,239 @@
 //
 
 #include "DataExporter.h"
-#include <sstream>
 
 namespace DosboxStagingReplacer {
-    std::string DataExporter::serialize(const std::vector<std::shared_ptr<SqlDataResult>> &dataset) {
-        std::ostringstream oss;
-        for (const auto &data: dataset) {
-            oss << this->stringify(*data) << std::endl;
+    void DataExporter::write(OutputSink &out, const std::vector<std::shared_ptr<SqlDataResult>> &dataset) {
+        this->writeHeader(out);
+        for (size_t i = 0; i < dataset.size(); ++i) {
+            this->writeRow(out, *dataset[i], i);
         }
-        return oss.str();
+        this->writeFooter(out);
     }
 
-    std::string DataExporter::serialize(const std::vector<InstallationInfo> &dataset) {
-        std::ostringstream oss;
-        for (const auto &data: dataset) {
-            oss << this->stringify(data) << std::endl;
+    void DataExporter::write(OutputSink &out, const std::vector<InstallationInfo> &dataset) {
+        this->writeHeader(out);
+        for (size_t i = 0; i < dataset.size(); ++i) {
+            this->writeRow(out, dataset[i], i);
         }
-        return oss.str();
+        this->writeFooter(out);
     }
-    std::string DataExporter::serialize(const std::vector<FileEntity> &dataset) {
-        std::ostringstream oss;
-        for (const auto &data: dataset) {
-            oss << this->stringify(data) << std::endl;
+
+    void DataExporter::write(OutputSink &out, const std::vector<FileEntity> &dataset) {
+        this->writeHeader(out);
+        for (size_t i = 0; i < dataset.size(); ++i) {
+            this->writeRow(out, dataset[i], i);
         }
-        return oss.str();
+        this->writeFooter(out);
+    }
+
+    std::string DataExporter::serialize(const std::vector<std::shared_ptr<SqlDataResult>> &dataset) {
+        MemorySink out;
+        this->write(out, dataset);
+        return out.takeContents();
+    }
+
+    std::string DataExporter::serialize(const std::vector<InstallationInfo> &dataset) {
+        MemorySink out;
+        this->write(out, dataset);
+        return out.takeContents();
+    }
+
+    std::string DataExporter::serialize(const std::vector<FileEntity> &dataset) {
+        MemorySink out;
+        this->write(out, dataset);
+        return out.takeContents();
     }
 
     std::string DataExporter::stringify(const SqlDataResult &data) {
-        std::ostringstream oss;
-        for (std::vector<std::tuple<std::string, std::string, DataResultDataType>> attributes = data.getAttributes();
-             const auto &attribute: attributes) {
-            std::string name, value;
-            DataResultDataType type;
-            std::tie(name, value, type) = attribute;
-            oss << name << "=" << value << this->separator;
-        }
-        return oss.str();
+        MemorySink out;
+        this->writeRecord(out, data);
+        return out.takeContents();
     }
 
     std::string DataExporter::stringify(const InstallationInfo &data) {
-        std::ostringstream oss;
-        oss << "applicationName=" << data.applicationName << this->separator
-            << "installationPath=" << data.installationPath << this->separator << "source=" << data.source;
-        return oss.str();
+        MemorySink out;
+        this->writeRecord(out, data);
+        return out.takeContents();
     }
 
     std::string DataExporter::stringify(const FileEntity &data) {
-        std::ostringstream oss;
-        oss << "name=" << data.name << this->separator
-            << "path=" << data.path << this->separator
-            << "type=" << data.getTypeName() << this->separator
-            << "size=" << data.size;
-        return oss.str();
+        MemorySink out;
+        this->writeRecord(out, data);
+        return out.takeContents();
     }
 
-    std::string JSONDataExporter::addEscapeCharacters(const std::string &str) {
-        std::string escapedStr = str;
-        // Escape backslashes
-        size_t pos = 0;
-        while ((pos = escapedStr.find('\\', pos)) != std::string::npos) {
-            escapedStr.replace(pos, 1, "\\\\");
-            pos += 2; // Move past the escaped backslash
-        }
-        // Escape double quotes
-        pos = 0;
-        while ((pos = escapedStr.find('\"', pos)) != std::string::npos) {
-            escapedStr.replace(pos, 1, "\\\"");
-            pos += 2; // Move past the escaped quote
-        }
-        return escapedStr;
+    void DataExporter::writeHeader(OutputSink &) {}
+
+    void DataExporter::writeRow(OutputSink &out, const SqlDataResult &data, size_t) {
+        this->writeRecord(out, data);
+        out.put('\n');
     }
 
-    std::string JSONDataExporter::serialize(const std::vector<std::shared_ptr<SqlDataResult>> &dataset) {
-        std::ostringstream oss;
-        oss << "[";
-        for (size_t i = 0; i < dataset.size(); ++i) {
-            oss << this->stringify(*dataset[i]);
-            if (i != dataset.size() - 1) {
-                oss << ",";
-            }
-        }
-        oss << "]";
-        return oss.str();
+    void DataExporter::writeRow(OutputSink &out, const InstallationInfo &data, size_t) {
+        this->writeRecord(out, data);
+        out.put('\n');
     }
 
-    std::string JSONDataExporter::serialize(const std::vector<InstallationInfo> &dataset) {
-        std::ostringstream oss;
-        oss << "[";
-        for (size_t i = 0; i < dataset.size(); ++i) {
-            oss << this->stringify(dataset[i]);
-            if (i != dataset.size() - 1) {
-                oss << ",";
-            }
-        }
-        oss << "]";
-        return oss.str();
+    void DataExporter::writeRow(OutputSink &out, const FileEntity &data, size_t) {
+        this->writeRecord(out, data);
+        out.put('\n');
     }
-    std::string JSONDataExporter::serialize(const std::vector<FileEntity> &dataset) {
-        std::ostringstream oss;
-        oss << "[";
-        for (size_t i = 0; i < dataset.size(); ++i) {
-            oss << this->stringify(dataset[i]);
-            if (i != dataset.size() - 1) {
-                oss << ",";
+
+    void DataExporter::writeFooter(OutputSink &) {}
+
+    void DataExporter::writeRecord(OutputSink &out, const SqlDataResult &data) {
+        // Writes every attribute as name=value followed by the separator, values keep their native type
+        class AttributeWriter final : public SqlAttributeVisitor {
+            OutputSink &out;
+            const std::string &separator;
+
+        public:
+            AttributeWriter(OutputSink &out, const std::string &separator) : out(out), separator(separator) {}
+            void visit(const std::string_view name, const int64_t value) override {
+                out << name << "=" << value << separator;
             }
-        }
-        oss << "]";
-        return oss.str();
-    }
-
-    std::string JSONDataExporter::stringify(const SqlDataResult &data) {
-        std::ostringstream oss;
-        oss << "{";
-        const std::vector<std::tuple<std::string, std::string, DataResultDataType>> attributes = data.getAttributes();
-        for (size_t i = 0; i < attributes.size(); ++i) {
-            std::string name, value;
-            DataResultDataType type;
-            std::tie(name, value, type) = attributes[i];
-
-            // Currently we need to wrap strings in quotes
-            if (type == DataResultDataType::String) {
-                // First we replace all the quotes with escaped quotes
-                value = addEscapeCharacters(value);
-                // Then we add the quotes
-                value.insert(0, "\"");
-                value.append("\"");
+            void visit(const std::string_view name, const bool value) override {
+                out << name << "=" << (value ? "true" : "false") << separator;
             }
-
-            oss << "\"" << name << "\": " << value;
-            if (i != attributes.size() - 1) {
-                oss << ",";
+            void visit(const std::string_view name, const std::string_view value) override {
+                out << name << "=" << value << separator;
             }
-        }
-        oss << "}";
-        return oss.str();
-    }
+        };
 
-    std::string JSONDataExporter::stringify(const InstallationInfo &data) {
-        std::ostringstream oss;
-        oss << R"({"applicationName": ")" << addEscapeCharacters(data.applicationName) << R"(", "installationPath": ")"
-            << addEscapeCharacters(data.installationPath) << R"(", "source": ")" << addEscapeCharacters(data.source)
-            << R"("})";
+        AttributeWriter writer(out, this->separator);
+        data.visitAttributes(writer);
+    }
 
-        return oss.str();
+    void DataExporter::writeRecord(OutputSink &out, const InstallationInfo &data) {
+        out << "applicationName=" << data.applicationName << this->separator
+            << "installationPath=" << data.installationPath << this->separator << "source=" << data.source;
     }
-    std::string JSONDataExporter::stringify(const FileEntity &data) {
-        std::ostringstream oss;
-        oss << R"({"name": ")" << addEscapeCharacters(data.name) << R"(", "path": ")" << addEscapeCharacters(data.path)
-            << R"(", "type": ")" << addEscapeCharacters(data.getTypeName()) << R"(", "size": )" << data.size << R"(})";
-        return oss.str();
+
+    void DataExporter::writeRecord(OutputSink &out, const FileEntity &data) {
+        out << "name=" << data.name << this->separator
+            << "path=" << data.path << this->separator
+            << "type=" << data.getTypeName() << this->separator
+            << "size=" << data.size;
     }
 
-    std::string CSVDataExporter::serialize(const std::vector<std::shared_ptr<SqlDataResult>> &dataset) {
-        std::ostringstream oss;
-        for (const auto &data: dataset) {
-            oss << this->stringify(*data) << std::endl;
+    void JSONDataExporter::writeEscaped(OutputSink &out, std::string_view str) {
+        // Backslashes and double quotes are escaped, the text between them is written as it is
+        for (auto pos = str.find_first_of("\\\""); pos != std::string_view::npos; pos = str.find_first_of("\\\"")) {
+            out.write(str.substr(0, pos));
+            out.put('\\');
+            out.put(str[pos]);
+            str.remove_prefix(pos + 1);
         }
-        return oss.str();
+        out.write(str);
     }
 
-    std::string CSVDataExporter::serialize(const std::vector<InstallationInfo> &dataset) {
-        std::ostringstream oss;
-        for (const auto &data: dataset) {
-            oss << this->stringify(data) << std::endl;
+    void JSONDataExporter::writeHeader(OutputSink &out) { out.put('['); }
+
+    void JSONDataExporter::writeRow(OutputSink &out, const SqlDataResult &data, const size_t index) {
+        if (index != 0) {
+            out.put(',');
         }
-        return oss.str();
+        this->writeRecord(out, data);
     }
-    std::string CSVDataExporter::serialize(const std::vector<FileEntity> &dataset) {
-        std::ostringstream oss;
-        for (const auto &data: dataset) {
-            oss << this->stringify(data) << std::endl;
+
+    void JSONDataExporter::writeRow(OutputSink &out, const InstallationInfo &data, const size_t index) {
+        if (index != 0) {
+            out.put(',');
         }
-        return oss.str();
+        this->writeRecord(out, data);
     }
 
-    std::string CSVDataExporter::stringify(const SqlDataResult &data) {
-        std::ostringstream oss;
-        for (std::vector<std::tuple<std::string, std::string, DataResultDataType>> attributes = data.getAttributes();
-             const auto &attribute: attributes) {
-            std::string name, value;
-            DataResultDataType type;
-            std::tie(name, value, type) = attribute;
-            oss << value << this->separator;
+    void JSONDataExporter::writeRow(OutputSink &out, const FileEntity &data, const size_t index) {
+        if (index != 0) {
+            out.put(',');
         }
-        return oss.str();
+        this->writeRecord(out, data);
+    }
+
+    void JSONDataExporter::writeFooter(OutputSink &out) { out.put(']'); }
+
+    void JSONDataExporter::writeRecord(OutputSink &out, const SqlDataResult &data) {
+        // Writes every attribute as a JSON member, only strings need to be quoted and escaped
+        class AttributeWriter final : public SqlAttributeVisitor {
+            OutputSink &out;
+            bool first = true;
+
+            void writeName(const std::string_view name) {
+                if (!first) {
+                    out.put(',');
+                }
+                first = false;
+                out << "\"" << name << "\": ";
+            }
+
+        public:
+            explicit AttributeWriter(OutputSink &out) : out(out) {}
+            void visit(const std::string_view name, const int64_t value) override {
+                writeName(name);
+                out << value;
+            }
+            void visit(const std::string_view name, const bool value) override {
+                writeName(name);
+                out << (value ? "true" : "false");
+            }
+            void visit(const std::string_view name, const std::string_view value) override {
+                writeName(name);
+                out.put('"');
+                writeEscaped(out, value);
+                out.put('"');
+            }
+        };
+
+        out.put('{');
+        AttributeWriter writer(out);
+        data.visitAttributes(writer);
+        out.put('}');
+    }
+
+    void JSONDataExporter::writeRecord(OutputSink &out, const InstallationInfo &data) {
+        out << R"({"applicationName": ")";
+        writeEscaped(out, data.applicationName);
+        out << R"(", "installationPath": ")";
+        writeEscaped(out, data.installationPath);
+        out << R"(", "source": ")";
+        writeEscaped(out, data.source);
+        out << R"("})";
+    }
+
+    void JSONDataExporter::writeRecord(OutputSink &out, const FileEntity &data) {
+        out << R"({"name": ")";
+        writeEscaped(out, data.name);
+        out << R"(", "path": ")";
+        writeEscaped(out, data.path);
+        out << R"(", "type": ")";
+        writeEscaped(out, data.getTypeName());
+        out << R"(", "size": )" << data.size << R"(})";
+    }
+
+    void CSVDataExporter::writeRecord(OutputSink &out, const SqlDataResult &data) {
+        // Writes every attribute value followed by the separator, values keep their native type
+        class AttributeWriter final : public SqlAttributeVisitor {
+            OutputSink &out;
+            const std::string &separator;
+
+        public:
+            AttributeWriter(OutputSink &out, const std::string &separator) : out(out), separator(separator) {}
+            void visit(std::string_view, const int64_t value) override { out << value << separator; }
+            void visit(std::string_view, const bool value) override { out << (value ? "true" : "false") << separator; }
+            void visit(std::string_view, const std::string_view value) override { out << value << separator; }
+        };
+
+        AttributeWriter writer(out, this->separator);
+        data.visitAttributes(writer);
     }
 
-    std::string CSVDataExporter::stringify(const InstallationInfo &data) {
-        std::ostringstream oss;
-        oss << data.applicationName << this->separator << data.installationPath << this->separator << data.source;
-        return oss.str();
+    void CSVDataExporter::writeRecord(OutputSink &out, const InstallationInfo &data) {
+        out << data.applicationName << this->separator << data.installationPath << this->separator << data.source;
     }
 
-    std::string CSVDataExporter::stringify(const FileEntity &data) {
-        std::ostringstream oss;
-        oss << data.name << this->separator << data.path << this->separator << data.getTypeName() << this->separator << data.size;
-        return oss.str();
+    void CSVDataExporter::writeRecord(OutputSink &out, const FileEntity &data) {
+        out << data.name << this->separator << data.path << this->separator << data.getTypeName() << this->separator
+            << data.size;
     }
 } // namespace DosboxStagingReplacer
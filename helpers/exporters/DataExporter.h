@@ -9,13 +9,15 @@
 
 #include "CoreHelperModels.h"
 #include "InstallationFinder.h"
+#include "OutputSink.h"
 #include "StatementParser.h"
 
 namespace DosboxStagingReplacer {
 
     /**
      * @brief Base class for exporting data from a dataset into a string format.
-     * Although all the methods are virtual, they do have working implementations.
+     * Rows are written straight into an OutputSink, one at a time, so no dataset is ever held as text.
+     * Although all the writers are virtual, they do have working implementations.
      */
     class DataExporter {
         std::string separator = ",";
@@ -26,143 +28,200 @@ namespace DosboxStagingReplacer {
         /// @brief Destructor
         virtual ~DataExporter() = default;
 
+        /**
+         * @brief Writes the SqlDataResult dataset, with its header and footer.
+         * @param out The sink to write to.
+         * @param dataset The dataset to write.
+         */
+        void write(OutputSink &out, const std::vector<std::shared_ptr<SqlDataResult>> &dataset);
+
+        /**
+         * @brief Writes the InstallationInfo dataset, with its header and footer.
+         * @param out The sink to write to.
+         * @param dataset The dataset to write.
+         */
+        void write(OutputSink &out, const std::vector<InstallationInfo> &dataset);
+
+        /**
+         * @brief Writes the FileEntity dataset, with its header and footer.
+         * @param out The sink to write to.
+         * @param dataset The dataset to write.
+         */
+        void write(OutputSink &out, const std::vector<FileEntity> &dataset);
+
         /**
          * @brief Serializes the SqlDataResult dataset into a string format.
          * @param dataset The dataset to serialize.
          * @return The serialized dataset as a string.
          */
-        virtual std::string serialize(const std::vector<std::shared_ptr<SqlDataResult>> &dataset);
+        std::string serialize(const std::vector<std::shared_ptr<SqlDataResult>> &dataset);
 
         /**
          * @brief Serializes the InstallInfo dataset into a string format.
          * @param dataset The dataset to serialize.
          * @return The serialized dataset as a string.
          */
-        virtual std::string serialize(const std::vector<InstallationInfo> &dataset);
+        std::string serialize(const std::vector<InstallationInfo> &dataset);
         /**
          * @brief Serializes the FileEntity dataset into a string format
          * @param dataset The FileEntity dataset to serialize
          * @return The serialized dataset as a string.
          */
-        virtual std::string serialize(const std::vector<FileEntity> &dataset);
+        std::string serialize(const std::vector<FileEntity> &dataset);
 
         /**
          * @brief Converts the SqlDataResult object into a string format.
          * @param data The SqlDataResult (and its derivatives) object to convert.
          * @return The string representation of the SqlDataResult object.
          */
-        virtual std::string stringify(const SqlDataResult &data);
-
+        std::string stringify(const SqlDataResult &data);
         /**
          * @brief Converts the InstallationInfo object into a string format.
          * @param data The InstallationInfo object to convert.
          * @return The string representation of the InstallationInfo object.
          */
-        virtual std::string stringify(const InstallationInfo &data);
+        std::string stringify(const InstallationInfo &data);
         /**
-         * @brief Converts the InstallationInfo object into a string format.
+         * @brief Converts the FileEntity object into a string format.
          * @param data The FileEntity object to convert.
-         * @return The string representation of the InstallationInfo object.
+         * @return The string representation of the FileEntity object.
+         */
+        std::string stringify(const FileEntity &data);
+
+        /**
+         * @brief Writes whatever has to precede the first row of a dataset.
+         * @param out The sink to write to.
+         */
+        virtual void writeHeader(OutputSink &out);
+
+        /**
+         * @brief Writes a single row of a SqlDataResult dataset, followed by a line break.
+         * Lets callers export rows as they are read instead of collecting them first.
+         * @param out The sink to write to.
+         * @param data The row to write.
+         * @param index The zero based position of the row in the dataset.
+         */
+        virtual void writeRow(OutputSink &out, const SqlDataResult &data, size_t index);
+        /**
+         * @brief Writes a single row of an InstallationInfo dataset, followed by a line break.
+         * @param out The sink to write to.
+         * @param data The row to write.
+         * @param index The zero based position of the row in the dataset.
          */
-        virtual std::string stringify(const FileEntity &data);
+        virtual void writeRow(OutputSink &out, const InstallationInfo &data, size_t index);
+        /**
+         * @brief Writes a single row of a FileEntity dataset, followed by a line break.
+         * @param out The sink to write to.
+         * @param data The row to write.
+         * @param index The zero based position of the row in the dataset.
+         */
+        virtual void writeRow(OutputSink &out, const FileEntity &data, size_t index);
+
+        /**
+         * @brief Writes whatever has to follow the last row of a dataset.
+         * @param out The sink to write to.
+         */
+        virtual void writeFooter(OutputSink &out);
+
+        /**
+         * @brief Writes the SqlDataResult object as name=value pairs.
+         * @param out The sink to write to.
+         * @param data The SqlDataResult (and its derivatives) object to write.
+         */
+        virtual void writeRecord(OutputSink &out, const SqlDataResult &data);
+        /**
+         * @brief Writes the InstallationInfo object as name=value pairs.
+         * @param out The sink to write to.
+         * @param data The InstallationInfo object to write.
+         */
+        virtual void writeRecord(OutputSink &out, const InstallationInfo &data);
+        /**
+         * @brief Writes the FileEntity object as name=value pairs.
+         * @param out The sink to write to.
+         * @param data The FileEntity object to write.
+         */
+        virtual void writeRecord(OutputSink &out, const FileEntity &data);
     };
 
     /**
      * @brief Derived class for exporting data in JSON format.
-     * Inherits from DataExporter and implements the serialization methods for JSON.
+     * Inherits from DataExporter and implements the writers for JSON.
      */
     class JSONDataExporter final : public DataExporter {
 
         /**
-         * @brief Adds escape characters to a string to make it JSON-safe.
+         * @brief Writes a string with escape characters added to make it JSON-safe.
+         * @param out The sink to write to.
          * @param str The string to escape.
-         * @return The escaped string.
          */
-        static std::string addEscapeCharacters(const std::string &str);
+        static void writeEscaped(OutputSink &out, std::string_view str);
 
         /**
-         * @brief Serializes the SqlDataResult dataset into JSON format.
-         * @param dataset The dataset to serialize.
-         * @return The serialized dataset as a JSON string.
+         * @brief Opens the JSON array of a dataset.
+         * @param out The sink to write to.
          */
-        std::string serialize(const std::vector<std::shared_ptr<SqlDataResult>> &dataset) override;
+        void writeHeader(OutputSink &out) override;
 
         /**
-         * @brief Serializes the InstallationInfo dataset into JSON format.
-         * @param dataset The dataset to serialize.
-         * @return The serialized dataset as a JSON string.
+         * @brief Writes a row as a JSON object, preceded by a separator unless it is the first one.
+         * @param out The sink to write to.
+         * @param data The row to write.
+         * @param index The zero based position of the row in the dataset.
          */
-        std::string serialize(const std::vector<InstallationInfo> &dataset) override;
+        void writeRow(OutputSink &out, const SqlDataResult &data, size_t index) override;
+        //! \copydoc JSONDataExporter::writeRow(OutputSink &, const SqlDataResult &, size_t)
+        void writeRow(OutputSink &out, const InstallationInfo &data, size_t index) override;
+        //! \copydoc JSONDataExporter::writeRow(OutputSink &, const SqlDataResult &, size_t)
+        void writeRow(OutputSink &out, const FileEntity &data, size_t index) override;
+
         /**
-         * @brief Serializes the InstallationInfo dataset into JSON format.
-         * @param dataset The FileEntity dataset to serialize.
-         * @return The serialized dataset as a JSON string.
+         * @brief Closes the JSON array of a dataset.
+         * @param out The sink to write to.
          */
-        std::string serialize(const std::vector<FileEntity> &dataset) override;
+        void writeFooter(OutputSink &out) override;
 
         /**
-         * @brief Converts the SqlDataResult object into a JSON string.
-         * @param data The SqlDataResult (and its derivatives) object to convert.
-         * @return The string representation of the SqlDataResult object in JSON.
+         * @brief Writes the SqlDataResult object as a JSON object.
+         * @param out The sink to write to.
+         * @param data The SqlDataResult (and its derivatives) object to write.
          */
-        std::string stringify(const SqlDataResult &data) override;
-
+        void writeRecord(OutputSink &out, const SqlDataResult &data) override;
         /**
-         * @brief Converts the InstallationInfo object into a JSON string.
-         * @param data The InstallationInfo object to convert.
-         * @return The string representation of the InstallationInfo object in JSON.
+         * @brief Writes the InstallationInfo object as a JSON object.
+         * @param out The sink to write to.
+         * @param data The InstallationInfo object to write.
          */
-        std::string stringify(const InstallationInfo &data) override;
+        void writeRecord(OutputSink &out, const InstallationInfo &data) override;
         /**
-         * @brief Converts a FileEntity object into a JSON string representation.
-         * @param data The FileEntity object to convert.
-         * @return The string representation of the InstallationInfo object in JSON.
+         * @brief Writes the FileEntity object as a JSON object.
+         * @param out The sink to write to.
+         * @param data The FileEntity object to write.
          */
-        std::string stringify(const FileEntity &data) override;
+        void writeRecord(OutputSink &out, const FileEntity &data) override;
     };
 
     class CSVDataExporter final : public DataExporter {
         std::string separator = ",";
     public:
         /**
-         * @brief Serializes the SqlDataResult dataset into JSON format.
-         * @param dataset The dataset to serialize.
-         * @return The serialized dataset as a JSON string.
-         */
-        std::string serialize(const std::vector<std::shared_ptr<SqlDataResult>> &dataset) override;
-
-        /**
-         * @brief Serializes the InstallationInfo dataset into JSON format.
-         * @param dataset The InstallationInfo dataset to serialize.
-         * @return The serialized dataset as a JSON string.
-         */
-        std::string serialize(const std::vector<InstallationInfo> &dataset) override;
-        /**
-         * @brief Serializes the FileEntity dataset into JSON format.
-         * @param dataset The FileEntity dataset to serialize.
-         * @return The serialized dataset as a JSON string.
+         * @brief Writes the values of the SqlDataResult object, each followed by the separator.
+         * @param out The sink to write to.
+         * @param data The SqlDataResult (and its derivatives) object to write.
          */
-        std::string serialize(const std::vector<FileEntity> &dataset) override;
+        void writeRecord(OutputSink &out, const SqlDataResult &data) override;
 
         /**
-         * @brief Converts the SqlDataResult object into a JSON string.
-         * @param data The SqlDataResult (and its derivatives) object to convert.
-         * @return The string representation of the SqlDataResult object in JSON.
-         */
-        std::string stringify(const SqlDataResult &data) override;
-
-        /**
-         * @brief Converts the InstallationInfo object into a JSON string.
-         * @param data The InstallationInfo object to convert.
-         * @return The string representation of the InstallationInfo object in JSON.
+         * @brief Writes the values of the InstallationInfo object separated by the separator.
+         * @param out The sink to write to.
+         * @param data The InstallationInfo object to write.
          */
-        std::string stringify(const InstallationInfo &data) override;
+        void writeRecord(OutputSink &out, const InstallationInfo &data) override;
         /**
-         * @brief Converts the InstallationInfo object into a JSON string.
-         * @param data The FileEntity object to convert.
-         * @return The string representation of the InstallationInfo object in JSON.
+         * @brief Writes the values of the FileEntity object separated by the separator.
+         * @param out The sink to write to.
+         * @param data The FileEntity object to write.
          */
-        std::string stringify(const FileEntity &data) override;
+        void writeRecord(OutputSink &out, const FileEntity &data) override;
     };
 
     /**
@@ -0,0 +1,229 @@
+#include "OutputSink.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DosboxStagingReplacer {
+
+    namespace {
+        /**
+         * @brief Writes all of the data to a file descriptor.
+         * @throws std::runtime_error If the descriptor cannot be written to.
+         */
+        void writeAll(const int fd, std::string_view data) {
+            while (!data.empty()) {
+#ifdef _WIN32
+                const auto written = _write(fd, data.data(), static_cast<unsigned int>(data.size()));
+#else
+                const auto written = ::write(fd, data.data(), data.size());
+#endif
+                if (written < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::runtime_error(std::string("Could not write the output: ") + std::strerror(errno));
+                }
+                // A pipe or a full disk can take less than asked for
+                data.remove_prefix(static_cast<size_t>(written));
+            }
+        }
+
+        int closeFile(const int fd) {
+#ifdef _WIN32
+            return _close(fd);
+#else
+            return close(fd);
+#endif
+        }
+    } // namespace
+
+    OutputSink::OutputSink(const size_t bufferSize) : buffer(bufferSize) {}
+
+    void OutputSink::write(const std::string_view text) {
+        if (this->used + text.size() <= this->buffer.size()) {
+            std::memcpy(this->buffer.data() + this->used, text.data(), text.size());
+            this->used += text.size();
+            return;
+        }
+        this->flush();
+        // Larger than the whole buffer, copying it there first would only cost a copy
+        if (text.size() >= this->buffer.size()) {
+            this->writeOut(text);
+            return;
+        }
+        std::memcpy(this->buffer.data(), text.data(), text.size());
+        this->used = text.size();
+    }
+
+    void OutputSink::put(const char character) {
+        if (this->used == this->buffer.size()) {
+            this->flush();
+            if (this->buffer.empty()) {
+                this->writeOut(std::string_view(&character, 1));
+                return;
+            }
+        }
+        this->buffer[this->used++] = character;
+    }
+
+    void OutputSink::flush() {
+        if (this->used > 0) {
+            // Emptied first, a destination that throws is not handed the same data again
+            const auto size = this->used;
+            this->used = 0;
+            this->writeOut(std::string_view(this->buffer.data(), size));
+        }
+    }
+
+    OutputSink &OutputSink::operator<<(const std::string_view text) {
+        this->write(text);
+        return *this;
+    }
+
+    OutputSink &OutputSink::operator<<(const char character) {
+        this->put(character);
+        return *this;
+    }
+
+    StdoutSink::~StdoutSink() {
+        try {
+            this->flush();
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+        std::fflush(stdout);
+    }
+
+    void StdoutSink::finish() {
+        this->flush();
+        if (std::fflush(stdout) != 0) {
+            throw std::runtime_error(std::string("Could not write the output: ") + std::strerror(errno));
+        }
+    }
+
+    void StdoutSink::writeOut(const std::string_view data) {
+        // A closed pipe or a full disk writes less than asked for
+        if (std::fwrite(data.data(), 1, data.size(), stdout) != data.size()) {
+            throw std::runtime_error(std::string("Could not write the output: ") + std::strerror(errno));
+        }
+    }
+
+    FileDescriptorSink::~FileDescriptorSink() {
+        try {
+            this->flush();
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
+
+    void FileDescriptorSink::writeOut(const std::string_view data) {
+        writeAll(this->fd, data);
+    }
+
+    AtomicFileSink::AtomicFileSink(std::string path, const size_t bufferSize) :
+        OutputSink(bufferSize), path(std::move(path)) {
+        // Next to the target so the rename never has to move the data to another file system. The name is unique so
+        // neither an unrelated file nor the temporary file of another export of the same target is overwritten
+        this->temporaryPath = this->path + ".XXXXXX";
+#ifdef _WIN32
+        if (_mktemp_s(this->temporaryPath.data(), this->temporaryPath.size() + 1) == 0) {
+            this->fd = _open(this->temporaryPath.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY,
+                             _S_IREAD | _S_IWRITE);
+        }
+#else
+        this->fd = mkstemp(this->temporaryPath.data());
+#endif
+        if (this->fd < 0) {
+            const std::string message = "Could not create a temporary file for " + this->path + ": " +
+                                        std::strerror(errno);
+            this->temporaryPath.clear();
+            throw std::runtime_error(message);
+        }
+#ifndef _WIN32
+        fcntl(this->fd, F_SETFD, FD_CLOEXEC);
+        // mkstemp only lets the owner read the file. An existing target keeps its mode, a new one gets the mode
+        // any other new file would get
+        struct stat target {};
+        mode_t mode;
+        if (stat(this->path.c_str(), &target) == 0) {
+            mode = target.st_mode & 07777;
+        } else {
+            // umask can only be read by setting it, so it is read once for the whole process
+            static const mode_t creationMask = [] {
+                const mode_t mask = umask(0);
+                umask(mask);
+                return mask;
+            }();
+            mode = 0666 & ~creationMask;
+        }
+        fchmod(this->fd, mode);
+#endif
+    }
+
+    AtomicFileSink::~AtomicFileSink() {
+        this->discard();
+    }
+
+    void AtomicFileSink::writeOut(const std::string_view data) {
+        if (this->fd < 0) {
+            throw std::runtime_error("Could not write " + this->path + ": the output was already finished");
+        }
+        writeAll(this->fd, data);
+    }
+
+    void AtomicFileSink::finish() {
+        if (this->fd < 0) {
+            // Already finished
+            return;
+        }
+        try {
+            this->flush();
+#ifndef _WIN32
+            // On disk before the rename, so a crash cannot leave an empty file under the name of the target
+            if (fsync(this->fd) != 0) {
+                throw std::runtime_error("Could not write " + this->temporaryPath + ": " + std::strerror(errno));
+            }
+#endif
+            const int descriptor = this->fd;
+            this->fd = -1;
+            if (closeFile(descriptor) != 0) {
+                throw std::runtime_error("Could not write " + this->temporaryPath + ": " + std::strerror(errno));
+            }
+            std::error_code error;
+            std::filesystem::rename(this->temporaryPath, this->path, error);
+            if (error) {
+                throw std::runtime_error("Could not replace " + this->path + ": " + error.message());
+            }
+            this->temporaryPath.clear();
+        } catch (...) {
+            this->discard();
+            throw;
+        }
+    }
+
+    void AtomicFileSink::discard() {
+        if (this->fd >= 0) {
+            closeFile(this->fd);
+            this->fd = -1;
+        }
+        if (!this->temporaryPath.empty()) {
+            std::error_code error;
+            std::filesystem::remove(this->temporaryPath, error);
+            this->temporaryPath.clear();
+        }
+    }
+
+} // namespace DosboxStagingReplacer
@@ -0,0 +1,201 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Buffered destination of exported data.
+     *
+     * Writes are collected in a fixed buffer that is handed to the destination once full, so exporting a row costs
+     * a copy into the buffer instead of a stream operation or a string of its own. Derived classes only decide where
+     * a full buffer goes.
+     */
+    class OutputSink {
+    public:
+        /// Bytes collected before they are handed to the destination
+        static constexpr size_t defaultBufferSize = 64 * 1024;
+
+        /**
+         * @brief Constructs the sink.
+         * @param bufferSize The size of the buffer, 0 hands every write to the destination as it is made.
+         */
+        explicit OutputSink(size_t bufferSize = defaultBufferSize);
+
+        /// @brief Destructor, derived classes flush what is left in their own destructor
+        virtual ~OutputSink() = default;
+
+        OutputSink(const OutputSink &) = delete;
+        OutputSink &operator=(const OutputSink &) = delete;
+
+        /**
+         * @brief Writes text.
+         */
+        void write(std::string_view text);
+
+        /**
+         * @brief Writes a single character.
+         */
+        void put(char character);
+
+        /**
+         * @brief Hands what is buffered to the destination.
+         */
+        void flush();
+
+        /**
+         * @brief Completes the output, called once everything was written.
+         * Flushes by default, see AtomicFileSink for a sink that needs it to keep what was written.
+         */
+        virtual void finish() { this->flush(); }
+
+        OutputSink &operator<<(std::string_view text);
+        OutputSink &operator<<(const std::string &text) { return *this << std::string_view(text); }
+        OutputSink &operator<<(const char *text) { return *this << std::string_view(text); }
+        OutputSink &operator<<(char character);
+
+        /**
+         * @brief Writes an integer in decimal, without going through a locale.
+         */
+        template<std::integral T>
+            requires(!std::same_as<T, char> && !std::same_as<T, bool>)
+        OutputSink &operator<<(const T value) {
+            char digits[24];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            this->write(std::string_view(digits, result.ptr - digits));
+            return *this;
+        }
+
+    protected:
+        /**
+         * @brief Writes data to the destination.
+         * @param data The data, a full buffer or a write larger than the buffer.
+         */
+        virtual void writeOut(std::string_view data) = 0;
+
+    private:
+        std::vector<char> buffer;
+        size_t used = 0;
+    };
+
+    /**
+     * @brief Sink writing to the standard output of the process.
+     * Goes through the C standard output, so it keeps its place among what is written with std::cout.
+     */
+    class StdoutSink final : public OutputSink {
+    public:
+        explicit StdoutSink(size_t bufferSize = defaultBufferSize) : OutputSink(bufferSize) {}
+        ~StdoutSink() override;
+
+        /**
+         * @brief Writes what is left, including what the C standard output still buffers.
+         * @throws std::runtime_error If the standard output cannot be written to.
+         */
+        void finish() override;
+
+    protected:
+        /// @throws std::runtime_error If the standard output cannot be written to.
+        void writeOut(std::string_view data) override;
+    };
+
+    /**
+     * @brief Sink writing to a file descriptor with a write call per full buffer.
+     * The descriptor is not closed by the sink.
+     */
+    class FileDescriptorSink final : public OutputSink {
+    public:
+        explicit FileDescriptorSink(int fd, size_t bufferSize = defaultBufferSize) :
+            OutputSink(bufferSize), fd(fd) {}
+        ~FileDescriptorSink() override;
+
+    protected:
+        /// @throws std::runtime_error If the descriptor cannot be written to.
+        void writeOut(std::string_view data) override;
+
+    private:
+        int fd;
+    };
+
+    /**
+     * @brief Sink writing a file that only appears once it is complete.
+     *
+     * Everything goes to a uniquely named temporary file next to the target in large writes, finish() then renames
+     * it over the target, keeping the permissions of the target. A sink destroyed without finish(), e.g. because an
+     * exception interrupted the export, removes the temporary file and leaves the target as it was.
+     */
+    class AtomicFileSink final : public OutputSink {
+    public:
+        /// Files take fewer, larger writes than the console
+        static constexpr size_t defaultFileBufferSize = 1024 * 1024;
+
+        /**
+         * @brief Creates the temporary file.
+         * @param path The file to write.
+         * @param bufferSize The size of the buffer.
+         * @throws std::runtime_error If the temporary file cannot be created.
+         */
+        explicit AtomicFileSink(std::string path, size_t bufferSize = defaultFileBufferSize);
+        ~AtomicFileSink() override;
+
+        /**
+         * @brief Writes what is left and replaces the target with the temporary file.
+         * @throws std::runtime_error If the file cannot be written or renamed, the target is then left as it was.
+         */
+        void finish() override;
+
+        /**
+         * @brief Returns the file written by the sink.
+         */
+        [[nodiscard]] const std::string &getPath() const { return this->path; }
+
+    protected:
+        /// @throws std::runtime_error If the temporary file cannot be written to.
+        void writeOut(std::string_view data) override;
+
+    private:
+        void discard();
+
+        std::string path;
+        std::string temporaryPath;
+        int fd = -1;
+    };
+
+    /**
+     * @brief Sink collecting everything written into a string.
+     */
+    class MemorySink final : public OutputSink {
+    public:
+        /// Nothing is buffered, the string itself is the buffer
+        MemorySink() : OutputSink(0) {}
+
+        /**
+         * @brief Returns everything written so far.
+         */
+        [[nodiscard]] const std::string &getContents() const { return this->contents; }
+
+        /**
+         * @brief Moves everything written so far out of the sink, leaving it empty.
+         */
+        std::string takeContents() {
+            std::string taken = std::move(this->contents);
+            this->contents.clear();
+            return taken;
+        }
+
+    protected:
+        void writeOut(std::string_view data) override { this->contents.append(data); }
+
+    private:
+        std::string contents;
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // OUTPUTSINK_H
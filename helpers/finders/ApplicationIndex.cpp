@@ -0,0 +1,75 @@
+#include "ApplicationIndex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+namespace DosboxStagingReplacer {
+
+    ApplicationIndex::ApplicationIndex(std::vector<InstallationInfo> applications) :
+        applications(std::move(applications)) {
+        std::string lowerName;
+        for (uint32_t i = 0; i < this->applications.size(); i++) {
+            lowerName = this->applications[i].applicationName;
+            std::ranges::transform(lowerName, lowerName.begin(), KeywordMatcher::toLower);
+            for (size_t position = 0; position + 3 <= lowerName.size(); position++) {
+                // Names are indexed in order, a trigram seen twice in a name is already at the back
+                auto &positions = this->postings[trigramAt(lowerName, position)];
+                if (positions.empty() || positions.back() != i)
+                    positions.push_back(i);
+            }
+        }
+    }
+
+    uint32_t ApplicationIndex::trigramAt(const std::string_view lowerText, const size_t position) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(lowerText[position])) << 16 |
+               static_cast<uint32_t>(static_cast<unsigned char>(lowerText[position + 1])) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(lowerText[position + 2]));
+    }
+
+    std::vector<InstallationInfo> ApplicationIndex::find(const KeywordMatcher &matcher) const {
+        std::vector<const std::vector<uint32_t> *> lists;
+        for (const auto &keyword: matcher.getKeywords()) {
+            for (size_t position = 0; position + 3 <= keyword.size(); position++) {
+                const auto found = this->postings.find(trigramAt(keyword, position));
+                if (found == this->postings.end()) {
+                    return {};
+                }
+                lists.push_back(&found->second);
+            }
+        }
+
+        std::vector<InstallationInfo> result;
+        if (lists.empty()) {
+            // Keywords shorter than a trigram cannot narrow the search, every name is compared
+            std::ranges::copy_if(this->applications, std::back_inserter(result), [&](const InstallationInfo &app) {
+                return matcher.matches(app.applicationName);
+            });
+            return result;
+        }
+
+        // Intersecting from the shortest list keeps every intermediate result as small as possible
+        std::ranges::sort(lists, {}, [](const std::vector<uint32_t> *list) { return list->size(); });
+        std::vector<uint32_t> candidates = *lists.front();
+        std::vector<uint32_t> remaining;
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+            if (lists[i] == lists[i - 1])
+                continue;
+            remaining.clear();
+            std::ranges::set_intersection(candidates, *lists[i], std::back_inserter(remaining));
+            candidates.swap(remaining);
+        }
+
+        // Holding every trigram does not mean holding them next to each other, the names are still compared
+        for (const auto candidate: candidates) {
+            if (matcher.matches(this->applications[candidate].applicationName))
+                result.push_back(this->applications[candidate]);
+        }
+        return result;
+    }
+
+    std::vector<InstallationInfo> ApplicationIndex::find(const std::string_view query) const {
+        return this->find(KeywordMatcher(query));
+    }
+
+} // namespace DosboxStagingReplacer
@@ -0,0 +1,56 @@
+#ifndef APPLICATIONINDEX_H
+#define APPLICATIONINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "InstallationFinder.h"
+#include "KeywordMatcher.h"
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Trigram index over the names of installed applications.
+     *
+     * Built once per list of applications, a search then only compares the names that hold every trigram of the
+     * keywords instead of every name of the list.
+     */
+    class ApplicationIndex {
+    public:
+        /**
+         * @brief Indexes the names of applications.
+         * @param applications The applications, usually the result of getInstalledApplications().
+         */
+        explicit ApplicationIndex(std::vector<InstallationInfo> applications);
+
+        /**
+         * @brief Finds the applications whose name contains every keyword of a matcher, ignoring case.
+         * @return The matching applications, in the order they were given to the index.
+         */
+        [[nodiscard]] std::vector<InstallationInfo> find(const KeywordMatcher &matcher) const;
+
+        /**
+         * @brief Finds the applications whose name contains every keyword of a query, ignoring case.
+         * @param query The keywords separated by whitespace.
+         */
+        [[nodiscard]] std::vector<InstallationInfo> find(std::string_view query) const;
+
+        /**
+         * @brief Returns the indexed applications.
+         */
+        [[nodiscard]] const std::vector<InstallationInfo> &getApplications() const { return this->applications; }
+
+    private:
+        static uint32_t trigramAt(std::string_view lowerText, size_t position);
+
+        std::vector<InstallationInfo> applications;
+        // Ascending positions in applications of the names holding each trigram
+        std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // APPLICATIONINDEX_H
@@ -0,0 +1,203 @@
+#include "ApplicationInventory.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include "DirectoryScanner.h"
+#include "OutputSink.h"
+
+namespace DosboxStagingReplacer {
+
+    namespace {
+        // Changed whenever the layout of the cache file changes, older files are then listed again
+        constexpr std::string_view cacheHeader = "DosboxStagingReplacer installed applications 1";
+
+        std::vector<std::string_view> splitFields(const std::string_view line) {
+            std::vector<std::string_view> fields;
+            size_t start = 0;
+            while (true) {
+                const auto end = line.find('\t', start);
+                fields.push_back(line.substr(start, end - start));
+                if (end == std::string_view::npos)
+                    return fields;
+                start = end + 1;
+            }
+        }
+
+        bool isStorable(const std::string_view field) {
+            return field.find_first_of("\t\n") == std::string_view::npos;
+        }
+    } // namespace
+
+    ApplicationInventory::ApplicationInventory(std::string cachePath, std::vector<std::string> databasePaths,
+                                               std::string context, Lister lister) :
+        cachePath(std::move(cachePath)), databasePaths(std::move(databasePaths)), context(std::move(context)),
+        lister(std::move(lister)) {}
+
+    ApplicationInventory &ApplicationInventory::system() {
+        static ApplicationInventory inventory = [] {
+            auto databasePaths = getPackageDatabasePaths();
+            // Without databases to stamp it with, a cache file would never be refreshed
+            auto cachePath = databasePaths.empty() ? std::string() : getDefaultCachePath();
+            // The commands of the packages are resolved through the PATH, so the list also changes when a command
+            // is added to or removed from one of its directories, which changes the directory's modification time
+            const char *searchPath = std::getenv("PATH");
+            for (auto &directory: ExecutableIndex::splitSearchPath(searchPath != nullptr ? searchPath : "")) {
+                databasePaths.push_back(std::move(directory));
+            }
+            return ApplicationInventory(std::move(cachePath), std::move(databasePaths),
+                                        searchPath != nullptr ? searchPath : "", [](bool &complete) {
+                                            std::vector<PackageSourceReport> reports;
+                                            auto applications =
+                                                    getInstalledApplications(defaultPackageSourceTimeout, &reports);
+                                            complete = std::ranges::none_of(reports, [](const auto &report) {
+                                                return report.timedOut || report.failed;
+                                            });
+                                            return applications;
+                                        });
+        }();
+        return inventory;
+    }
+
+    std::string ApplicationInventory::getCacheDirectory() {
+        std::filesystem::path cacheDirectory;
+#ifdef _WIN32
+        if (const char *localAppData = std::getenv("LOCALAPPDATA"); localAppData != nullptr && *localAppData) {
+            cacheDirectory = localAppData;
+        }
+#else
+        if (const char *cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome != nullptr && *cacheHome) {
+            cacheDirectory = cacheHome;
+        } else if (const char *home = std::getenv("HOME"); home != nullptr && *home) {
+            cacheDirectory = std::filesystem::path(home) / ".cache";
+        }
+#endif
+        if (cacheDirectory.empty()) {
+            return {};
+        }
+        return (cacheDirectory / "DosboxStagingReplacer").string();
+    }
+
+    std::string ApplicationInventory::getDefaultCachePath() {
+        const auto cacheDirectory = getCacheDirectory();
+        if (cacheDirectory.empty()) {
+            return {};
+        }
+        return (std::filesystem::path(cacheDirectory) / "installed-applications.cache").string();
+    }
+
+    ApplicationInventory::Applications ApplicationInventory::getApplications() {
+        std::lock_guard lock(this->mutex);
+        // Read before listing, so a change made while listing is seen on the next call
+        auto currentStamps = this->readStamps();
+        if (this->applications && currentStamps == this->stamps) {
+            return this->applications;
+        }
+
+        if (auto cached = this->load(currentStamps)) {
+            this->applications = std::move(cached);
+            this->stamps = std::move(currentStamps);
+            return this->applications;
+        }
+
+        bool complete = true;
+        auto listed = std::make_shared<const std::vector<InstallationInfo>>(this->lister(complete));
+        this->listCount++;
+        if (complete) {
+            this->save(currentStamps, *listed);
+        }
+        this->applications = std::move(listed);
+        this->stamps = std::move(currentStamps);
+        return this->applications;
+    }
+
+    size_t ApplicationInventory::getListCount() const {
+        std::lock_guard lock(this->mutex);
+        return this->listCount;
+    }
+
+    std::vector<ApplicationInventory::Stamp> ApplicationInventory::readStamps() const {
+        std::vector<Stamp> result;
+        result.reserve(this->databasePaths.size());
+        for (const auto &path: this->databasePaths) {
+            result.push_back({path, DirectoryScanner::readModifiedTime(path)});
+        }
+        return result;
+    }
+
+    ApplicationInventory::Applications ApplicationInventory::load(const std::vector<Stamp> &currentStamps) const {
+        if (this->cachePath.empty()) {
+            return nullptr;
+        }
+        std::ifstream file(this->cachePath);
+        std::string line;
+        if (!std::getline(file, line) || line != cacheHeader) {
+            return nullptr;
+        }
+        if (!std::getline(file, line) || line != "C\t" + this->context) {
+            return nullptr;
+        }
+
+        // S<tab>modification time<tab>path for every database, in order, then A<tab>name<tab>path<tab>source
+        auto cached = std::make_shared<std::vector<InstallationInfo>>();
+        size_t stampCount = 0;
+        while (std::getline(file, line)) {
+            const auto fields = splitFields(line);
+            if (fields.size() == 3 && fields[0] == "S") {
+                int64_t modifiedTime = 0;
+                if (std::from_chars(fields[1].data(), fields[1].data() + fields[1].size(), modifiedTime).ec !=
+                            std::errc() ||
+                    stampCount >= currentStamps.size() || currentStamps[stampCount].path != fields[2] ||
+                    currentStamps[stampCount].modifiedTime != modifiedTime) {
+                    return nullptr;
+                }
+                stampCount++;
+            } else if (fields.size() == 4 && fields[0] == "A") {
+                cached->push_back({std::string(fields[1]), std::string(fields[2]), std::string(fields[3])});
+            } else {
+                return nullptr;
+            }
+        }
+        if (stampCount != currentStamps.size()) {
+            return nullptr;
+        }
+        return cached;
+    }
+
+    void ApplicationInventory::save(const std::vector<Stamp> &currentStamps,
+                                    const std::vector<InstallationInfo> &listed) const {
+        if (this->cachePath.empty() || !isStorable(this->context)) {
+            return;
+        }
+        const bool storable = std::ranges::all_of(currentStamps, [](const Stamp &stamp) {
+            return isStorable(stamp.path);
+        }) && std::ranges::all_of(listed, [](const InstallationInfo &app) {
+            return isStorable(app.applicationName) && isStorable(app.installationPath) && isStorable(app.source);
+        });
+        if (!storable) {
+            return;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(this->cachePath).parent_path(), error);
+        try {
+            AtomicFileSink file(this->cachePath);
+            file << cacheHeader << '\n' << "C\t" << this->context << '\n';
+            for (const auto &stamp: currentStamps) {
+                file << "S\t" << stamp.modifiedTime << '\t' << stamp.path << '\n';
+            }
+            for (const auto &app: listed) {
+                file << "A\t" << app.applicationName << '\t' << app.installationPath << '\t' << app.source << '\n';
+            }
+            file.finish();
+        } catch (const std::exception &e) {
+            std::cerr << "Warning: Could not write the application cache " << this->cachePath << ": " << e.what()
+                      << std::endl;
+        }
+    }
+
+} // namespace DosboxStagingReplacer
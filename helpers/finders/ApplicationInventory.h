@@ -0,0 +1,95 @@
+#ifndef APPLICATIONINVENTORY_H
+#define APPLICATIONINVENTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "InstallationFinder.h"
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Installed applications, listed again only once the package databases change.
+     *
+     * The list is kept in memory for the process and in a cache file for the following runs, both are stamped with
+     * the modification times of the package databases. Reading the stamps costs one stat per database, listing the
+     * applications again only happens when one of them differs.
+     */
+    class ApplicationInventory {
+    public:
+        /// Shared by every caller, never modified once returned
+        using Applications = std::shared_ptr<const std::vector<InstallationInfo>>;
+        /**
+         * @brief Lists the applications, setting complete to false when some of them could not be listed.
+         * An incomplete list is used by the process but never written to the cache file.
+         */
+        using Lister = std::function<std::vector<InstallationInfo>(bool &complete)>;
+
+        /**
+         * @brief Creates an inventory.
+         * @param cachePath The cache file, empty to only keep the list in memory.
+         * @param databasePaths The files and directories whose modification times stamp the list.
+         * @param context Anything else the list depends on, e.g. the PATH its commands were resolved with.
+         * @param lister Lists the applications when the stamps changed.
+         */
+        ApplicationInventory(std::string cachePath, std::vector<std::string> databasePaths, std::string context,
+                             Lister lister);
+
+        /**
+         * @brief Returns the inventory of the system, cached under the user cache directory.
+         * Stamped with the package databases and the directories of the PATH the commands are resolved in.
+         */
+        static ApplicationInventory &system();
+
+        /**
+         * @brief Returns the directory of the program under the user cache directory, empty if the user has none.
+         */
+        static std::string getCacheDirectory();
+
+        /**
+         * @brief Returns the default cache file, empty if the user has no cache directory.
+         */
+        static std::string getDefaultCachePath();
+
+        /**
+         * @brief Returns the installed applications, from memory, the cache file or the lister in that order.
+         * Safe to call from several threads.
+         */
+        Applications getApplications();
+
+        /**
+         * @brief Returns the number of times the lister was called.
+         */
+        [[nodiscard]] size_t getListCount() const;
+
+    private:
+        struct Stamp {
+            std::string path;
+            int64_t modifiedTime = 0;
+
+            bool operator==(const Stamp &) const = default;
+        };
+
+        [[nodiscard]] std::vector<Stamp> readStamps() const;
+        [[nodiscard]] Applications load(const std::vector<Stamp> &stamps) const;
+        void save(const std::vector<Stamp> &stamps, const std::vector<InstallationInfo> &applications) const;
+
+        std::string cachePath;
+        std::vector<std::string> databasePaths;
+        std::string context;
+        Lister lister;
+
+        mutable std::mutex mutex;
+        Applications applications;
+        std::vector<Stamp> stamps;
+        size_t listCount = 0;
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // APPLICATIONINVENTORY_H
@@ -0,0 +1,71 @@
+#include "ExecutableIndex.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include "DirectoryScanner.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace DosboxStagingReplacer {
+
+    ExecutableIndex::ExecutableIndex(const std::string_view searchPath) {
+        for (const auto &directory: splitSearchPath(searchPath)) {
+            try {
+                // Only the names are needed, sizes would cost a stat per entry
+                for (const auto &file: DirectoryScanner::entries(directory, {.readSizes = false,
+                                                                              .type = FileType::FILE})) {
+                    if (this->executables.contains(file.name))
+                        continue;
+#ifndef _WIN32
+                    if (access(file.path.c_str(), X_OK) != 0)
+                        continue;
+#endif
+                    this->executables.emplace(file.name, file.path);
+                }
+            } catch (const std::filesystem::filesystem_error &) {
+                // Directories of the search path that do not exist are common and harmless
+            }
+        }
+    }
+
+    const ExecutableIndex &ExecutableIndex::system() {
+        // Initialized once even when called from several threads
+        static const ExecutableIndex index([] {
+            const char *searchPath = std::getenv("PATH");
+            return std::string_view(searchPath != nullptr ? searchPath : "");
+        }());
+        return index;
+    }
+
+    std::vector<std::string> ExecutableIndex::splitSearchPath(const std::string_view searchPath) {
+#ifdef _WIN32
+        constexpr char separator = ';';
+#else
+        constexpr char separator = ':';
+#endif
+        std::vector<std::string> directories;
+        size_t start = 0;
+        while (start <= searchPath.size()) {
+            auto end = searchPath.find(separator, start);
+            if (end == std::string_view::npos)
+                end = searchPath.size();
+            if (end != start) {
+                directories.emplace_back(searchPath.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        return directories;
+    }
+
+    std::string ExecutableIndex::find(const std::string_view name) const {
+        const auto found = this->executables.find(name);
+        return found != this->executables.end() ? found->second : std::string();
+    }
+
+    bool ExecutableIndex::contains(const std::string_view name) const {
+        return this->executables.contains(name);
+    }
+
+} // namespace DosboxStagingReplacer
@@ -0,0 +1,68 @@
+#ifndef EXECUTABLEINDEX_H
+#define EXECUTABLEINDEX_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Index of the executables reachable through a PATH like search path.
+     *
+     * Built with one read per directory of the search path, after which resolving a command is a single
+     * hash lookup, instead of a shell running command -v for each name.
+     */
+    class ExecutableIndex {
+    public:
+        /**
+         * @brief Scans the directories of a search path.
+         * @param searchPath Directories separated like the PATH variable, the first one holding a name wins.
+         * Empty entries are skipped rather than meaning the current directory.
+         */
+        explicit ExecutableIndex(std::string_view searchPath);
+
+        /**
+         * @brief Returns the index of the PATH of the process.
+         * It is built on the first call and shared afterwards, changes made to PATH later are not seen.
+         */
+        static const ExecutableIndex &system();
+
+        /**
+         * @brief Splits a search path into its directories, in order and without empty entries.
+         * @param searchPath Directories separated like the PATH variable.
+         */
+        static std::vector<std::string> splitSearchPath(std::string_view searchPath);
+
+        /**
+         * @brief Resolves a command name.
+         * @param name The command name, e.g. dosbox.
+         * @return The absolute path of the executable, empty if the name is not in the search path.
+         */
+        [[nodiscard]] std::string find(std::string_view name) const;
+
+        /**
+         * @brief Checks whether a command name is in the search path.
+         */
+        [[nodiscard]] bool contains(std::string_view name) const;
+
+        /**
+         * @brief Returns the number of executables indexed.
+         */
+        [[nodiscard]] size_t size() const { return this->executables.size(); }
+
+    private:
+        struct NameHash {
+            using is_transparent = void;
+            size_t operator()(const std::string_view name) const { return std::hash<std::string_view>{}(name); }
+        };
+
+        std::unordered_map<std::string, std::string, NameHash, std::equal_to<>> executables;
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // EXECUTABLEINDEX_H
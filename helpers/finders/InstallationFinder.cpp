@@ -4,14 +4,19 @@
 
 #include "InstallationFinder.h"
 
-namespace DosboxStagingReplacer {
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <numeric>
+#include <thread>
+#include <unordered_set>
+#include "ApplicationInventory.h"
+#include "CommandRunner.h"
+#include "DirectoryScanner.h"
+#include "KeywordMatcher.h"
 
-    // Platform specific code first
-#ifdef __linux__
-    // Originally I want to use libraries like libapt, libdpkg, librpm, libflatpak, and libsnapd
-    // But I think it's better to use the command line tools instead as it prevents the need to install additional libraries
-    // Furthermore it will be more portable as it will work on any Linux distribution
-    #define DELIMITER '\t'
+namespace DosboxStagingReplacer {
 
     #define APT "apt"
     #define FLATPAK "flatpak"
@@ -19,73 +24,209 @@ namespace DosboxStagingReplacer {
     #define DPKG "dpkg"
     #define RPM "rpm"
 
-    #define APT_COMMAND "apt list --installed 2>/dev/null | awk -F/ 'NR>1 {print $1}' | xargs -I{} sh -c 'p=$(command -v {} 2>/dev/null); echo \"{}\t$p\tapt\"'"
-    #define FLATPAK_COMMAND "flatpak list --app --columns=application | tail -n +1 | xargs -I{} sh -c 'p=$(flatpak info --show-location {} 2>/dev/null); echo \"{}\t$p\tflatpak\"'"
-    #define SNAP_COMMAND "snap list | awk 'NR>1 {print $1}' | xargs -I{} sh -c 'p=$(command -v {} 2>/dev/null); echo \"{},$p,snap\"'"
-    #define DPKG_COMMAND "dpkg -l | awk 'NR>5 {print $2}' | xargs -I{} sh -c 'p=$(command -v {} 2>/dev/null); echo \"{}\t$p\tdpkg\"'"
-    #define RPM_COMMAND "rpm -qa --qf '%{NAME}\n' | xargs -I{} sh -c 'p=$(command -v {} 2>/dev/null); echo \"{},$p,rpm\"'"
+    std::vector<std::string> readDpkgInstalledPackages(const std::string &statusPath, const std::stop_token &stop) {
+        std::vector<std::string> packages;
+        std::ifstream file(statusPath);
+        if (!file.is_open()) {
+            return packages;
+        }
+        // Packages of several architectures have one stanza each but the same name
+        std::unordered_set<std::string> seen;
+        std::string line;
+        std::string package;
+        bool installed = false;
+        const auto endStanza = [&] {
+            if (installed && !package.empty() && seen.insert(package).second) {
+                packages.push_back(package);
+            }
+            package.clear();
+            installed = false;
+        };
+        // Stanzas are separated by empty lines, continuation lines of long fields start with a space
+        while (std::getline(file, line)) {
+            if (stop.stop_requested()) {
+                return {};
+            }
+            if (line.empty()) {
+                endStanza();
+            } else if (line.starts_with("Package:")) {
+                // A field without a value leaves the stanza without a package, so it is skipped
+                const auto start = line.find_first_not_of(' ', 8);
+                package = start != std::string::npos ? line.substr(start) : std::string();
+            } else if (line.starts_with("Status:")) {
+                // Status: <wanted> <error> <state>, only the state installed means the files are on disk
+                installed = line.ends_with(" installed");
+            }
+        }
+        endStanza();
+        // Sorted like apt list and dpkg -l print them
+        std::ranges::sort(packages);
+        return packages;
+    }
+
+    std::vector<InstallationInfo> readFlatpakApplications(const std::string &installationPath,
+                                                          const std::stop_token &stop) {
+        std::vector<InstallationInfo> applications;
+        const auto appPath = std::filesystem::path(installationPath) / "app";
+        std::error_code error;
+        if (!std::filesystem::is_directory(appPath, error)) {
+            return applications;
+        }
+        for (const auto &app: DirectoryScanner::entries(appPath.string(), {.readSizes = false,
+                                                                             .type = FileType::DIRECTORY})) {
+            if (stop.stop_requested()) {
+                return {};
+            }
+            // app/<id>/current links to <arch>/<branch>, whose active link is the deployed commit
+            const auto location = std::filesystem::canonical(std::filesystem::path(app.path) / "current" / "active", error);
+            if (error) {
+                continue;
+            }
+            InstallationInfo info;
+            info.applicationName = app.name;
+            info.installationPath = location.string();
+            info.source = FLATPAK;
+            applications.push_back(std::move(info));
+        }
+        std::ranges::sort(applications, {}, &InstallationInfo::applicationName);
+        return applications;
+    }
+
+    std::vector<InstallationInfo> readSnapApplications(const std::string &snapPath, const ExecutableIndex &executables,
+                                                       const std::stop_token &stop) {
+        std::vector<std::string> snaps;
+        std::error_code error;
+        if (!std::filesystem::is_directory(snapPath, error)) {
+            return {};
+        }
+        for (const auto &snap: DirectoryScanner::entries(snapPath, {.readSizes = false, .type = FileType::DIRECTORY})) {
+            if (stop.stop_requested()) {
+                return {};
+            }
+            // /snap/bin holds the commands, every installed snap has a current revision
+            if (snap.name != "bin" && std::filesystem::exists(std::filesystem::path(snap.path) / "current", error)) {
+                snaps.push_back(snap.name);
+            }
+        }
+        std::ranges::sort(snaps);
+        return resolvePackageExecutables(snaps, SNAP, executables);
+    }
+
+    std::vector<InstallationInfo> resolvePackageExecutables(const std::vector<std::string> &packages,
+                                                            const std::string &source,
+                                                            const ExecutableIndex &executables) {
+        std::vector<InstallationInfo> registeredApplications;
+        registeredApplications.reserve(packages.size());
+        for (const auto &package: packages) {
+            InstallationInfo info;
+            info.applicationName = package;
+            info.installationPath = executables.find(package);
+            info.source = source;
+            registeredApplications.push_back(std::move(info));
+        }
+        return registeredApplications;
+    }
+
+    // Platform specific code first
+#ifdef __linux__
+    // Libraries like libapt, libdpkg, librpm, libflatpak, and libsnapd are avoided, they would have to be installed too
+    // The dpkg status file and the Flatpak and Snap directories are plain files that every version of these tools
+    // keeps in the same place, so they are read directly without starting the tools. Only the rpm database needs
+    // its command line tool to be read
+
+    #define DPKG_STATUS_PATH "/var/lib/dpkg/status"
+    #define FLATPAK_SYSTEM_PATH "/var/lib/flatpak"
+    #define SNAP_PATH "/snap"
+    #define RPM_QUERY_FORMAT "%{NAME}\t%{ARCH}\n"
+    #define RPM_DATABASE_PATHS {"/var/lib/rpm/rpmdb.sqlite", "/var/lib/rpm/Packages", "/usr/lib/sysimage/rpm/rpmdb.sqlite"}
+    #define SNAPD_STATE_PATH "/var/lib/snapd/state.json"
 
 
     bool isAptAvailable() {
-        return !executeCommand("command -v apt").empty();
+        return ExecutableIndex::system().contains(APT);
     }
 
     bool isFlatpakAvailable() {
-        return !executeCommand("command -v flatpak").empty();
+        return ExecutableIndex::system().contains(FLATPAK);
     }
 
     bool isSnapAvailable() {
-        return !executeCommand("command -v snap").empty();
+        return ExecutableIndex::system().contains(SNAP);
     }
 
     bool isDpkgAvailable() {
-        return !executeCommand("command -v dpkg").empty();
+        return ExecutableIndex::system().contains(DPKG);
     }
 
     bool isRpmAvailable() {
-        return !executeCommand("command -v rpm").empty();
-    }
-
-    std::vector<InstallationInfo> getRegisteredApplications(const std::string &commands, const std::string &source) {
-        std::vector<InstallationInfo> registeredApplications;
-        std::string output = executeCommand(commands);
-        // Get all lines from the output and process each line
-        std::istringstream stream(output);
-        std::string line;
-        while (std::getline(stream, line)) {
-            // Split the line by the tab character
-            std::istringstream lineStream(line);
-            std::string applicationName;
-            std::string installationPath;
-            std::getline(lineStream, applicationName, DELIMITER);
-            std::getline(lineStream, installationPath, DELIMITER);
-            InstallationInfo info;
-            info.applicationName = applicationName;
-            info.installationPath = installationPath;
-            info.source = source;
-            registeredApplications.push_back(info);
-        }
-        return registeredApplications;
+        return ExecutableIndex::system().contains(RPM);
     }
 
-    std::vector<InstallationInfo> getRegisteredApplicationsFromApt() {
-        return getRegisteredApplications(APT_COMMAND, APT);
+    std::vector<InstallationInfo> getRegisteredApplicationsFromApt(const ExecutableIndex &executables,
+                                                                   const std::stop_token &stop) {
+        return resolvePackageExecutables(readDpkgInstalledPackages(DPKG_STATUS_PATH, stop), APT, executables);
     }
 
-    std::vector<InstallationInfo> getRegisteredApplicationsFromFlatpak() {
-        return getRegisteredApplications(FLATPAK_COMMAND, FLATPAK);
+    namespace {
+        /**
+         * @brief Returns the system installation of Flatpak, then the installation of the current user if it has one.
+         * These are the same directories flatpak itself uses, including its environment overrides.
+         */
+        std::vector<std::string> getFlatpakInstallationPaths() {
+            std::vector<std::string> paths{FLATPAK_SYSTEM_PATH};
+            if (const char *overridePath = std::getenv("FLATPAK_SYSTEM_DIR"); overridePath != nullptr && *overridePath) {
+                paths.front() = overridePath;
+            }
+            if (const char *overridePath = std::getenv("FLATPAK_USER_DIR"); overridePath != nullptr && *overridePath) {
+                paths.emplace_back(overridePath);
+            } else if (const char *dataHome = std::getenv("XDG_DATA_HOME"); dataHome != nullptr && *dataHome) {
+                paths.push_back((std::filesystem::path(dataHome) / "flatpak").string());
+            } else if (const char *home = std::getenv("HOME"); home != nullptr && *home) {
+                paths.push_back((std::filesystem::path(home) / ".local" / "share" / "flatpak").string());
+            }
+            return paths;
+        }
+    } // namespace
+
+    std::vector<InstallationInfo> getRegisteredApplicationsFromFlatpak(const std::stop_token &stop) {
+        std::vector<InstallationInfo> applications;
+        for (const auto &installationPath: getFlatpakInstallationPaths()) {
+            auto installationApplications = readFlatpakApplications(installationPath, stop);
+            applications.insert(applications.end(), std::make_move_iterator(installationApplications.begin()),
+                                std::make_move_iterator(installationApplications.end()));
+        }
+        return applications;
     }
 
-    std::vector<InstallationInfo> getRegisteredApplicationsFromSnap() {
-        return getRegisteredApplications(SNAP_COMMAND, SNAP);
+    std::vector<InstallationInfo> getRegisteredApplicationsFromSnap(const ExecutableIndex &executables,
+                                                                    const std::stop_token &stop) {
+        return readSnapApplications(SNAP_PATH, executables, stop);
     }
 
-    std::vector<InstallationInfo> getRegisteredApplicationsFromDpkg() {
-        return getRegisteredApplications(DPKG_COMMAND, DPKG);
+    std::vector<InstallationInfo> getRegisteredApplicationsFromDpkg(const ExecutableIndex &executables,
+                                                                    const std::stop_token &stop) {
+        return resolvePackageExecutables(readDpkgInstalledPackages(DPKG_STATUS_PATH, stop), DPKG, executables);
     }
 
-    std::vector<InstallationInfo> getRegisteredApplicationsFromRpm() {
-        return getRegisteredApplications(RPM_COMMAND, RPM);
+    std::vector<InstallationInfo> getRegisteredApplicationsFromRpm(const ExecutableIndex &executables,
+                                                                   const std::stop_token &stop) {
+        // A single rpm process lists every name, the commands are resolved in process
+        std::vector<std::string> packages;
+        std::array<std::string_view, 2> fields;
+        const auto result = CommandRunner::run({RPM, "-qa", "--qf", RPM_QUERY_FORMAT}, [&](const std::string_view line) {
+            // The public keys imported into rpm are listed as gpg-pubkey packages without an architecture
+            if (CommandRunner::splitFields(line, fields) == 2 && !fields[0].empty() && fields[1] != "(none)") {
+                packages.emplace_back(fields[0]);
+            }
+        }, {.stop = stop});
+        if (result.stopped) {
+            // Given up on by the caller, which may already be exiting
+            return {};
+        }
+        // Packages installed for several architectures are listed once per architecture
+        std::ranges::sort(packages);
+        packages.erase(std::ranges::unique(packages).begin(), packages.end());
+        return resolvePackageExecutables(packages, RPM, executables);
     }
 
 #elif _WIN32
@@ -148,85 +289,174 @@ namespace DosboxStagingReplacer {
 
 #endif
 
-    std::vector<InstallationInfo> getInstalledApplications() {
-        auto result = std::vector<InstallationInfo>();
+    std::vector<std::string> getPackageDatabasePaths() {
+        std::vector<std::string> paths;
+#ifdef __linux__
+        paths.emplace_back(DPKG_STATUS_PATH);
+        // The rpm database moved between versions and comes in several formats, whichever exists is the one in use
+        for (const auto *rpmPath: RPM_DATABASE_PATHS) {
+            paths.emplace_back(rpmPath);
+        }
+        for (const auto &installationPath: getFlatpakInstallationPaths()) {
+            // Flatpak touches .changed on every install, update and removal, app gains or loses a directory
+            paths.push_back((std::filesystem::path(installationPath) / ".changed").string());
+            paths.push_back((std::filesystem::path(installationPath) / "app").string());
+        }
+        paths.emplace_back(SNAP_PATH);
+        paths.emplace_back(SNAPD_STATE_PATH);
+#endif
+        return paths;
+    }
+
+    std::vector<PackageSource> getPackageSources() {
+        std::vector<PackageSource> sources;
 #ifdef _WIN32
-        auto win32_apps = getRegisteredApplicationsFromWindows();
-        result.insert(result.end(), win32_apps.begin(), win32_apps.end());
+        sources.push_back({"registry", [](std::stop_token) { return getRegisteredApplicationsFromWindows(); }});
 #elif __linux__
+        // Resolves the command of every package without starting a shell for each of them
+        const auto &executables = ExecutableIndex::system();
         // Apt logic code, also if dpkg is available as well (because dpkg is a dependency of apt)
         // Apt will be used to get the list of installed applications
-        if (isAptAvailable() || isDpkgAvailable()) {
-            if (isAptAvailable()) {
-                auto apt_apps = getRegisteredApplicationsFromApt();
-                result.insert(result.end(), apt_apps.begin(), apt_apps.end());
+        if (const bool aptAvailable = isAptAvailable(); aptAvailable || isDpkgAvailable()) {
+            if (aptAvailable) {
+                sources.push_back({APT, [&executables](const std::stop_token &stop) {
+                    return getRegisteredApplicationsFromApt(executables, stop);
+                }});
             }
             else {
-                auto dpkg_apps = getRegisteredApplicationsFromDpkg();
-                result.insert(result.end(), dpkg_apps.begin(), dpkg_apps.end());
+                sources.push_back({DPKG, [&executables](const std::stop_token &stop) {
+                    return getRegisteredApplicationsFromDpkg(executables, stop);
+                }});
             }
         }
         if (isRpmAvailable()) {
-            auto rpm_apps = getRegisteredApplicationsFromRpm();
-            result.insert(result.end(), rpm_apps.begin(), rpm_apps.end());
+            sources.push_back({RPM, [&executables](const std::stop_token &stop) {
+                return getRegisteredApplicationsFromRpm(executables, stop);
+            }});
         }
         if (isFlatpakAvailable()) {
-            auto flatpak_apps = getRegisteredApplicationsFromFlatpak();
-            result.insert(result.end(), flatpak_apps.begin(), flatpak_apps.end());
+            sources.push_back({FLATPAK, [](const std::stop_token &stop) {
+                return getRegisteredApplicationsFromFlatpak(stop);
+            }});
         }
         if (isSnapAvailable()) {
-            auto snap_apps = getRegisteredApplicationsFromSnap();
-            result.insert(result.end(), snap_apps.begin(), snap_apps.end());
+            sources.push_back({SNAP, [&executables](const std::stop_token &stop) {
+                return getRegisteredApplicationsFromSnap(executables, stop);
+            }});
         }
-
 #endif
-        return result;
+        return sources;
     }
 
-    std::string executeCommand(const std::string &command) {
-        std::array<char, 512> buffer{};
-        std::string result;
+    std::vector<InstallationInfo> queryPackageSources(const std::vector<PackageSource> &sources,
+                                                      const std::chrono::milliseconds timeout,
+                                                      std::vector<PackageSourceReport> *reports) {
+        using Clock = std::chrono::steady_clock;
+        struct Query {
+            std::promise<std::vector<InstallationInfo>> applications;
+            std::chrono::milliseconds timeout{};
+            Clock::time_point deadline;
+            Clock::duration duration{};
+        };
+
+        std::vector<Query> queries(sources.size());
+        std::vector<std::future<std::vector<InstallationInfo>>> results;
+        results.reserve(sources.size());
+        for (auto &query: queries) {
+            results.push_back(query.applications.get_future());
+        }
+        // Declared after the queries so the threads are joined before the queries they fill go away. A timed out
+        // source is asked to stop through the token of its thread and joined at the end of the call
+        std::vector<std::jthread> threads;
+        threads.reserve(sources.size());
+        for (size_t i = 0; i < sources.size(); i++) {
+            queries[i].timeout = sources[i].timeout.count() != 0 ? sources[i].timeout : timeout;
+            queries[i].deadline = Clock::now() + queries[i].timeout;
+            threads.emplace_back([&query = queries[i], &read = sources[i].read](const std::stop_token &stop) {
+                const auto start = Clock::now();
+                try {
+                    auto applications = read(stop);
+                    query.duration = Clock::now() - start;
+                    query.applications.set_value(std::move(applications));
+                } catch (...) {
+                    query.duration = Clock::now() - start;
+                    query.applications.set_exception(std::current_exception());
+                }
+            });
+        }
 
-        const std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
-        if (!pipe) throw std::runtime_error("popen() failed!");
+        // Waited for by deadline, so no source is given more time because another one was waited for first
+        std::vector<size_t> byDeadline(sources.size());
+        std::iota(byDeadline.begin(), byDeadline.end(), 0);
+        std::ranges::stable_sort(byDeadline, {}, [&](const size_t i) { return queries[i].deadline; });
+        std::vector<char> timedOut(sources.size(), 0);
+        for (const size_t i: byDeadline) {
+            if (results[i].wait_until(queries[i].deadline) != std::future_status::ready) {
+                threads[i].request_stop();
+                timedOut[i] = 1;
+            }
+        }
 
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += std::string(buffer.data());
+        // Merged in the order of the sources so the result does not depend on which one finished first
+        std::vector<InstallationInfo> result;
+        std::unordered_set<std::string> seen;
+        if (reports != nullptr) {
+            reports->clear();
+        }
+        for (size_t i = 0; i < sources.size(); i++) {
+            PackageSourceReport report;
+            report.name = sources[i].name;
+            if (timedOut[i]) {
+                report.duration = queries[i].timeout;
+                report.timedOut = true;
+                std::cerr << "Warning: " << sources[i].name << " did not list its packages within "
+                          << queries[i].timeout.count() << " ms, they are left out" << std::endl;
+            } else {
+                try {
+                    for (auto &app: results[i].get()) {
+                        if (seen.insert(app.applicationName + '\n' + app.installationPath + '\n' + app.source).second) {
+                            result.push_back(std::move(app));
+                            report.applicationCount++;
+                        }
+                    }
+                } catch (const std::exception &e) {
+                    report.failed = true;
+                    std::cerr << "Warning: Could not list the packages of " << sources[i].name << ": " << e.what()
+                              << std::endl;
+                } catch (...) {
+                    report.failed = true;
+                    std::cerr << "Warning: Could not list the packages of " << sources[i].name << std::endl;
+                }
+                report.duration = std::chrono::duration_cast<std::chrono::microseconds>(queries[i].duration);
+            }
+            if (reports != nullptr) {
+                reports->push_back(std::move(report));
+            }
         }
         return result;
     }
 
+    std::vector<InstallationInfo> getInstalledApplications(const std::chrono::milliseconds timeout,
+                                                           std::vector<PackageSourceReport> *reports) {
+        return queryPackageSources(getPackageSources(), timeout, reports);
+    }
+
+    std::vector<InstallationInfo> getInstalledApplications() {
+        return getInstalledApplications(defaultPackageSourceTimeout);
+    }
+
     bool lazyStringMatching(const std::string &text, const std::vector<std::string> &keywords) {
-        std::string lowerText = text;
-        std::ranges::transform(lowerText, lowerText.begin(), tolower);
-        int matchCount = 0;
-        for (const auto &keyword : keywords) {
-            // Create a copy of keyword and store it to k
-            std::string k = keyword;
-            std::ranges::transform(k, k.begin(), tolower);
-            if (lowerText.find(keyword) != std::string::npos) {
-                matchCount += 1;
-            }
-        }
-        return keywords.size() == matchCount;
+        return KeywordMatcher(keywords).matches(text);
     }
 
     std::vector<InstallationInfo> InstallationFinder::findApplication(const std::string &applicationName) {
+        // The query is lowercased and split once, not once per installed application
+        const KeywordMatcher matcher(applicationName);
         std::vector<InstallationInfo> result;
-        for (auto installedApps = getInstalledApplications(); auto &app : installedApps) {
-            // Lowercase the application name for case-insensitive comparison
-            std::string lowerAppName = applicationName;
-            std::ranges::transform(lowerAppName, lowerAppName.begin(), tolower);
-            // Split the application name by spaces and then consider that as keywords to fed to lazyStringMatching
-            std::istringstream iss(lowerAppName);
-            std::vector<std::string> keywords;
-            std::string keyword;
-            while (iss >> keyword) {
-                keywords.push_back(keyword);
-            }
-
+        // Listed only when the package databases changed since the last call, or the last run
+        for (const auto &app: *ApplicationInventory::system().getApplications()) {
             // Check if the application name contains all the keywords and if so, add it to the result
-            if (lazyStringMatching(app.applicationName, keywords)) {
+            if (matcher.matches(app.applicationName)) {
                 result.push_back(app);
             }
         }
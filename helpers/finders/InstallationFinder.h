@@ -7,12 +7,17 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <stop_token>
 #include <string>
 #include <vector>
 
+#include "ExecutableIndex.h"
+
 #ifdef _WIN32
 #include <windows.h>
 #else
@@ -23,7 +28,7 @@ namespace DosboxStagingReplacer {
 
     /*
      * InstallationInfo struct. Contains the information about an installed application
-     * Note: When updating the struct, make sure to update DataExporter::stringify as well
+     * Note: When updating the struct, make sure to update DataExporter::writeRecord as well
      */
     struct InstallationInfo {
         std::string applicationName;
@@ -31,23 +36,114 @@ namespace DosboxStagingReplacer {
         std::string source;
     };
 
+    /**
+     * @brief A source of installed applications, e.g. a package manager.
+     */
+    struct PackageSource {
+        std::string name;
+        /**
+         * @brief Reads the applications of the source.
+         * Called on its own thread, it should return early once a stop is requested on the token.
+         */
+        std::function<std::vector<InstallationInfo>(std::stop_token)> read;
+        /// Time given to the source from the moment it starts, 0 uses the timeout of the query
+        std::chrono::milliseconds timeout{0};
+    };
+
+    /**
+     * @brief How a package source did when it was queried.
+     */
+    struct PackageSourceReport {
+        std::string name;
+        std::chrono::microseconds duration{0};
+        size_t applicationCount = 0;
+        bool timedOut = false;
+        bool failed = false;
+    };
+
+    /**
+     * @brief Time given to every package source by getInstalledApplications().
+     */
+    constexpr std::chrono::milliseconds defaultPackageSourceTimeout{30000};
+
     /**
      * @brief Utility class that provides the functionality to find an application in the system.
      * @return A vector of InstallationInfo objects containing the information about the installed applications.
      */
     std::vector<InstallationInfo> getInstalledApplications();
     /**
-     * @brief Utility function to check if a command is available in the system.
-     * @param command The command to check.
-     * @return True if the command is available, false otherwise.
+     * @brief Lists the installed applications, querying every package source of the system at the same time.
+     * @param timeout The time given to the sources, the applications of a source that takes longer are left out.
+     * @param reports Optional, receives one report per source in the order of getPackageSources().
+     * @return The applications of every source, in the order of the sources whatever the order they finished in.
+     */
+    std::vector<InstallationInfo> getInstalledApplications(std::chrono::milliseconds timeout,
+                                                           std::vector<PackageSourceReport> *reports = nullptr);
+    /**
+     * @brief Returns the files and directories the package managers change when packages are installed or removed.
+     * Paths that do not exist on this system are included too, they change when the package manager is installed.
      */
-    std::string executeCommand(const std::string &command);
+    std::vector<std::string> getPackageDatabasePaths();
+    /**
+     * @brief Returns the package sources available in the system.
+     */
+    std::vector<PackageSource> getPackageSources();
+    /**
+     * @brief Queries package sources concurrently and merges their applications.
+     * A source still running when its timeout expires is asked to stop and its applications are left out, a source
+     * that throws is left out as well. Applications listed twice with the same path and source are kept once.
+     * Returns once every source thread has finished, so sources have to honour the stop request.
+     * @param sources The sources to query, each one is read on its own thread.
+     * @param timeout The time given to every source without a timeout of its own, counted from its start.
+     * @param reports Optional, receives one report per source in the order of the sources.
+     * @return The applications of the sources, in the order of the sources.
+     */
+    std::vector<InstallationInfo> queryPackageSources(const std::vector<PackageSource> &sources,
+                                                      std::chrono::milliseconds timeout,
+                                                      std::vector<PackageSourceReport> *reports = nullptr);
     /**
      * @brief Utility function to match strings from a set of keywords.
+     * Every keyword must be in the text, ignoring case. KeywordMatcher avoids lowercasing the keywords again when
+     * the same keywords are matched against many texts.
      * @param text The text to search in.
      * @param keywords The keywords to search for.
      */
     bool lazyStringMatching(const std::string &text, const std::vector<std::string> &keywords);
+    /**
+     * @brief Reads the names of the installed packages from a dpkg status database.
+     * @param statusPath The status file, /var/lib/dpkg/status on Debian based systems.
+     * @param stop Requested when the caller no longer waits for the result, checked on every line.
+     * @return The package names sorted and without duplicates. Empty if the file cannot be read or on a stop.
+     */
+    std::vector<std::string> readDpkgInstalledPackages(const std::string &statusPath,
+                                                       const std::stop_token &stop = {});
+    /**
+     * @brief Reads the applications deployed in a Flatpak installation.
+     * @param installationPath The installation directory, e.g. /var/lib/flatpak.
+     * @param stop Requested when the caller no longer waits for the result, checked on every application.
+     * @return One InstallationInfo per application, with the path of its active deployment. Empty on a stop.
+     */
+    std::vector<InstallationInfo> readFlatpakApplications(const std::string &installationPath,
+                                                          const std::stop_token &stop = {});
+    /**
+     * @brief Reads the snaps mounted under a snap directory.
+     * @param snapPath The snap directory, /snap on most systems.
+     * @param executables The index used to resolve the command of each snap.
+     * @param stop Requested when the caller no longer waits for the result, checked on every snap.
+     * @return One InstallationInfo per snap, with the path of its command if it has one. Empty on a stop.
+     */
+    std::vector<InstallationInfo> readSnapApplications(const std::string &snapPath, const ExecutableIndex &executables,
+                                                       const std::stop_token &stop = {});
+    /**
+     * @brief Builds the InstallationInfo of packages, resolving each package name as a command.
+     * @param packages The package names.
+     * @param source The source of the packages.
+     * @param executables The index used to resolve the commands.
+     * @return One InstallationInfo per package, the path is empty for packages without a command of the same name.
+     */
+    std::vector<InstallationInfo> resolvePackageExecutables(const std::vector<std::string> &packages,
+                                                            const std::string &source,
+                                                            const ExecutableIndex &executables);
 
 #ifdef __linux__
     /**
@@ -70,39 +166,46 @@ namespace DosboxStagingReplacer {
      * @brief Utility function specific to Linux to check if Snap is installed in the system.
      */
     bool isSnapAvailable();
-    /**
-     * @brief Utility function specific to Linux to obtain the list of installed applications.
-     * @param commands The command to execute.
-     * @param source The source of the application
-     * @return A vector of InstallationInfo objects containing the information about the installed applications.
-     */
-    std::vector<InstallationInfo> getRegisteredApplications(const std::string &commands,
-                                                                                   const std::string &source);
     /**
      * @brief Utility function specific to Linux to obtain the list of installed applications from Apt.
+     * Apt shares the dpkg database, which is read directly.
+     * @param executables The index used to resolve the command of each package.
+     * @param stop Requested when the caller no longer waits for the result.
      * @return A vector of InstallationInfo objects containing the information about the installed applications.
      */
-    std::vector<InstallationInfo> getRegisteredApplicationsFromApt();
+    std::vector<InstallationInfo> getRegisteredApplicationsFromApt(const ExecutableIndex &executables,
+                                                                   const std::stop_token &stop = {});
     /**
      * @brief Utility function specific to Linux to obtain the list of installed applications from Dpkg.
+     * @param executables The index used to resolve the command of each package.
+     * @param stop Requested when the caller no longer waits for the result.
      * @return A vector of InstallationInfo objects containing the information about the installed applications.
      */
-    std::vector<InstallationInfo> getRegisteredApplicationsFromDpkg();
+    std::vector<InstallationInfo> getRegisteredApplicationsFromDpkg(const ExecutableIndex &executables,
+                                                                    const std::stop_token &stop = {});
     /**
      * @brief Utility function specific to Linux to obtain the list of installed applications from Rpm.
+     * @param executables The index used to resolve the command of each package.
+     * @param stop Requested when the caller no longer waits for the result.
      * @return A vector of InstallationInfo objects containing the information about the installed applications.
      */
-    std::vector<InstallationInfo> getRegisteredApplicationsFromRpm();
+    std::vector<InstallationInfo> getRegisteredApplicationsFromRpm(const ExecutableIndex &executables,
+                                                                   const std::stop_token &stop = {});
     /**
      * @brief Utility function specific to Linux to obtain the list of installed applications from Flatpak.
+     * Both the system installation and the installation of the current user are read.
+     * @param stop Requested when the caller no longer waits for the result.
      * @return A vector of InstallationInfo objects containing the information about the installed applications.
      */
-    std::vector<InstallationInfo> getRegisteredApplicationsFromFlatpak();
+    std::vector<InstallationInfo> getRegisteredApplicationsFromFlatpak(const std::stop_token &stop = {});
     /**
      * @brief Utility function specific to Linux to obtain the list of installed applications from Snap.
+     * @param executables The index used to resolve the command of each snap.
+     * @param stop Requested when the caller no longer waits for the result.
      * @return A vector of InstallationInfo objects containing the information about the installed applications.
      */
-    std::vector<InstallationInfo> getRegisteredApplicationsFromSnap();
+    std::vector<InstallationInfo> getRegisteredApplicationsFromSnap(const ExecutableIndex &executables,
+                                                                    const std::stop_token &stop = {});
 #elif _WIN32
     /**
      * @brief Utility function specific to Windows to obtain the list of installed applications.
@@ -118,6 +221,7 @@ namespace DosboxStagingReplacer {
     public:
         /**
          * @brief Finds an application by name in the registered applications in the system.
+         * The applications come from ApplicationInventory::system(), so repeated calls do not list them again.
          * @param applicationName The name of the application to search for.
          * @return A vector of InstallationInfo objects matching the application name.
          */
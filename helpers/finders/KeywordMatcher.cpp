@@ -0,0 +1,41 @@
+#include "KeywordMatcher.h"
+
+#include <algorithm>
+
+namespace DosboxStagingReplacer {
+
+    KeywordMatcher::KeywordMatcher(const std::string_view query) {
+        constexpr std::string_view whitespace = " \t\n\v\f\r";
+        size_t start = query.find_first_not_of(whitespace);
+        while (start != std::string_view::npos) {
+            const auto end = std::min(query.find_first_of(whitespace, start), query.size());
+            this->addKeyword(query.substr(start, end - start));
+            start = query.find_first_not_of(whitespace, end);
+        }
+    }
+
+    KeywordMatcher::KeywordMatcher(const std::vector<std::string> &keywords) {
+        for (const auto &keyword: keywords) {
+            if (!keyword.empty())
+                this->addKeyword(keyword);
+        }
+    }
+
+    void KeywordMatcher::addKeyword(const std::string_view keyword) {
+        std::string lowered(keyword);
+        std::ranges::transform(lowered, lowered.begin(), toLower);
+        this->keywords.push_back(std::move(lowered));
+    }
+
+    char KeywordMatcher::toLower(const char character) {
+        return character >= 'A' && character <= 'Z' ? static_cast<char>(character - 'A' + 'a') : character;
+    }
+
+    bool KeywordMatcher::matches(const std::string_view text) const {
+        return std::ranges::all_of(this->keywords, [text](const std::string &keyword) {
+            // Only the text is lowercased, one character at a time as it is compared
+            return !std::ranges::search(text, keyword, std::ranges::equal_to{}, toLower).empty();
+        });
+    }
+
+} // namespace DosboxStagingReplacer
@@ -0,0 +1,54 @@
+#ifndef KEYWORDMATCHER_H
+#define KEYWORDMATCHER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Case-insensitive matcher of the keywords of a search query.
+     *
+     * The query is lowercased and split once, matching a text then compares it in place without copying or
+     * lowercasing it, so the same matcher can be run against every installed application.
+     */
+    class KeywordMatcher {
+    public:
+        /**
+         * @brief Compiles a query.
+         * @param query The keywords separated by whitespace, e.g. "dosbox staging".
+         */
+        explicit KeywordMatcher(std::string_view query);
+
+        /**
+         * @brief Compiles a list of keywords that are already split.
+         * @param keywords The keywords, empty ones are ignored.
+         */
+        explicit KeywordMatcher(const std::vector<std::string> &keywords);
+
+        /**
+         * @brief Checks whether a text contains every keyword, ignoring case.
+         * A matcher without keywords matches every text.
+         */
+        [[nodiscard]] bool matches(std::string_view text) const;
+
+        /**
+         * @brief Returns the lowercased keywords.
+         */
+        [[nodiscard]] const std::vector<std::string> &getKeywords() const { return this->keywords; }
+
+        /**
+         * @brief Lowercases the ASCII letters of a character, other characters are returned as they are.
+         */
+        static char toLower(char character);
+
+    private:
+        void addKeyword(std::string_view keyword);
+
+        std::vector<std::string> keywords;
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // KEYWORDMATCHER_H
@@ -4,23 +4,522 @@
 
 #include "DirectoryScanner.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
+#include <unordered_set>
+#include "WorkStealingPool.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace DosboxStagingReplacer {
 
-    std::vector<FileEntity> DirectoryScanner::scanDirectory(const std::string& path) {
+    namespace {
+
+        /**
+         * @brief Reads a directory through std::filesystem::directory_iterator.
+         * Types come from the iterator's cached entry, sizes cost a stat each.
+         */
+        class PortableReader {
+            std::filesystem::directory_iterator iterator;
+            std::filesystem::directory_entry current;
+            std::string currentName;
+            bool started = false;
+
+        public:
+            explicit PortableReader(const std::string &path) : iterator(path) {}
+
+            bool next() {
+                if (this->started) {
+                    ++this->iterator;
+                }
+                this->started = true;
+                if (this->iterator == std::filesystem::directory_iterator()) {
+                    return false;
+                }
+                this->current = *this->iterator;
+                this->currentName = this->current.path().filename().string();
+                return true;
+            }
+
+            [[nodiscard]] std::string_view name() const { return this->currentName; }
+
+            void path(std::string &out) const { out.assign(this->current.path().string()); }
+
+            [[nodiscard]] FileType type() const {
+                std::error_code error;
+                return this->current.is_directory(error) ? FileType::DIRECTORY : FileType::FILE;
+            }
+
+            [[nodiscard]] bool isSymlink() const {
+                std::error_code error;
+                return this->current.is_symlink(error);
+            }
+
+            [[nodiscard]] unsigned long size() const {
+                std::error_code error;
+                const auto size = this->current.file_size(error);
+                return error ? 0 : size;
+            }
+
+            [[nodiscard]] int64_t modifiedTime() const {
+                return DirectoryScanner::readModifiedTime(this->current.path().string());
+            }
+        };
+
+#ifdef __linux__
+        /**
+         * @brief Layout of the records returned by getdents64, see getdents(2).
+         */
+        struct DirentRecord {
+            uint64_t inode;
+            int64_t offset;
+            unsigned short length;
+            unsigned char type;
+            char name[1];
+        };
+
+        /**
+         * @brief Reads a directory with getdents64 in large batches.
+         *
+         * The entry type reported by the kernel is trusted, fstatat is only called for symbolic links,
+         * file systems that do not report types, and when the size is requested.
+         */
+        class GetdentsReader {
+            static constexpr size_t bufferSize = 128 * 1024;
+
+            std::string directory;
+            std::string prefix;
+            int fd;
+            std::unique_ptr<char[]> buffer = std::make_unique<char[]>(bufferSize);
+            long length = 0;
+            long offset = 0;
+            const DirentRecord *current = nullptr;
+            struct stat status {};
+            int statResult = 0;
+            bool statted = false;
+
+            const struct stat *statCurrent() {
+                if (!this->statted) {
+                    this->statResult = fstatat(this->fd, this->current->name, &this->status, 0);
+                    this->statted = true;
+                }
+                return this->statResult == 0 ? &this->status : nullptr;
+            }
+
+        public:
+            explicit GetdentsReader(const std::string &path) :
+                directory(path), prefix((std::filesystem::path(path) / "").string()),
+                fd(open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)) {
+                if (this->fd < 0) {
+                    throw std::filesystem::filesystem_error("directory iterator cannot open directory", path,
+                                                            std::error_code(errno, std::generic_category()));
+                }
+            }
+
+            GetdentsReader(const GetdentsReader &) = delete;
+            GetdentsReader &operator=(const GetdentsReader &) = delete;
+
+            ~GetdentsReader() { close(this->fd); }
+
+            bool next() {
+                while (true) {
+                    if (this->offset >= this->length) {
+                        this->length = syscall(SYS_getdents64, this->fd, this->buffer.get(), bufferSize);
+                        if (this->length < 0) {
+                            throw std::filesystem::filesystem_error("directory iterator cannot read directory",
+                                                                    this->directory,
+                                                                    std::error_code(errno, std::generic_category()));
+                        }
+                        if (this->length == 0) {
+                            return false;
+                        }
+                        this->offset = 0;
+                    }
+                    this->current = reinterpret_cast<const DirentRecord *>(this->buffer.get() + this->offset);
+                    this->offset += this->current->length;
+                    this->statted = false;
+                    if (const std::string_view entryName = this->current->name; entryName != "." && entryName != "..") {
+                        return true;
+                    }
+                }
+            }
+
+            [[nodiscard]] std::string_view name() const { return this->current->name; }
+
+            void path(std::string &out) const { out.assign(this->prefix).append(this->current->name); }
+
+            FileType type() {
+                switch (this->current->type) {
+                    case DT_DIR:
+                        return FileType::DIRECTORY;
+                    case DT_REG:
+                        return FileType::FILE;
+                    default:
+                        // Symbolic links are followed like std::filesystem does, unknown types need a stat anyway
+                        const auto *entryStatus = this->statCurrent();
+                        return entryStatus && S_ISDIR(entryStatus->st_mode) ? FileType::DIRECTORY : FileType::FILE;
+                }
+            }
+
+            unsigned long size() {
+                const auto *entryStatus = this->statCurrent();
+                return entryStatus ? static_cast<unsigned long>(entryStatus->st_size) : 0;
+            }
+
+            int64_t modifiedTime() {
+                const auto *entryStatus = this->statCurrent();
+                return entryStatus ? static_cast<int64_t>(entryStatus->st_mtim.tv_sec) * 1000000000 +
+                                             entryStatus->st_mtim.tv_nsec
+                                   : 0;
+            }
+
+            [[nodiscard]] bool isSymlink() const {
+                if (this->current->type != DT_UNKNOWN) {
+                    return this->current->type == DT_LNK;
+                }
+                struct stat linkStatus {};
+                return fstatat(this->fd, this->current->name, &linkStatus, AT_SYMLINK_NOFOLLOW) == 0 &&
+                       S_ISLNK(linkStatus.st_mode);
+            }
+        };
+#endif
+
+        bool equalsIgnoreCase(const char a, const char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        }
+
+        /**
+         * @brief The filters of a ScanOptions, evaluated against the entry a reader is positioned on.
+         *
+         * Checks run from the cheapest to the most expensive: the name, then the type which is usually free,
+         * then the size which needs a stat. A rejected entry never gets a FileEntity.
+         */
+        class EntryFilter {
+            const ScanOptions &options;
+            bool filtersSize;
+
+        public:
+            explicit EntryFilter(const ScanOptions &options) :
+                options(options),
+                filtersSize(options.minSize != 0 || options.maxSize != std::numeric_limits<unsigned long>::max()) {}
+
+            template<typename Reader>
+            bool accepts(Reader &reader) const {
+                const std::string_view name = reader.name();
+                if (!this->options.namePrefixes.empty() &&
+                    std::ranges::none_of(this->options.namePrefixes, [&](const std::string &prefix) {
+                        return name.starts_with(prefix);
+                    })) {
+                    return false;
+                }
+                if (!this->options.suffixes.empty() &&
+                    std::ranges::none_of(this->options.suffixes, [&](const std::string &suffix) {
+                        return name.size() >= suffix.size() &&
+                               std::ranges::equal(name.substr(name.size() - suffix.size()), suffix, equalsIgnoreCase);
+                    })) {
+                    return false;
+                }
+                if (!this->options.nameGlobs.empty() &&
+                    std::ranges::none_of(this->options.nameGlobs, [&](const std::string &glob) {
+                        return DirectoryScanner::matchesGlob(glob, name, this->options.globsIgnoreCase);
+                    })) {
+                    return false;
+                }
+                if (this->options.type == FileType::NONE && !this->filtersSize) {
+                    return true;
+                }
+                const auto type = reader.type();
+                if (this->options.type != FileType::NONE && type != this->options.type) {
+                    return false;
+                }
+                if (this->filtersSize && type != FileType::DIRECTORY) {
+                    const auto size = reader.size();
+                    return size >= this->options.minSize && size <= this->options.maxSize;
+                }
+                return true;
+            }
+        };
+
+        /**
+         * @brief Fills a FileEntity from the entry a reader is positioned on.
+         */
+        template<typename Reader>
+        void readEntry(Reader &reader, FileEntity &file, const ScanOptions &options) {
+            file.name.assign(reader.name());
+            reader.path(file.path);
+            file.type = reader.type();
+            file.size = file.type != FileType::DIRECTORY && options.readSizes ? reader.size() : 0;
+        }
+
+        template<typename Reader>
+        class BackendReader final : public DirectoryReader {
+            Reader reader;
+            ScanOptions options;
+            EntryFilter filter{this->options};
+
+        public:
+            BackendReader(const std::string &path, const ScanOptions &options) : reader(path), options(options) {}
+
+            bool next(FileEntity &file) override {
+                while (this->reader.next()) {
+                    if (this->filter.accepts(this->reader)) {
+                        readEntry(this->reader, file, this->options);
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
 
+        template<typename Reader>
+        bool anyEntryName(const std::string &path, const std::function<bool(std::string_view name)> &predicate) {
+            Reader reader(path);
+            while (reader.next()) {
+                if (predicate(reader.name()))
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief A directory of a recursive scan, its entries and the nodes of the subdirectories to descend into.
+         * Entries only keep their name, their path is the prefix of the directory followed by the name.
+         */
+        struct ScanNode {
+            struct Item {
+                std::string name;
+                FileType type;
+                unsigned long size;
+                int64_t modifiedTime;
+                bool matched;
+                std::unique_ptr<ScanNode> child;
+            };
+
+            std::string path;
+            std::string prefix;
+            int depth = 0;
+            int64_t modifiedTime = 0;
+            std::vector<Item> items;
+        };
+
+        /**
+         * @brief Canonical paths of the directories already scanned, only used when symbolic links are followed.
+         */
+        class VisitedDirectories {
+            std::mutex mutex;
+            std::unordered_set<std::string> paths;
+
+        public:
+            bool insert(const std::string &path) {
+                std::error_code error;
+                auto canonicalPath = std::filesystem::canonical(path, error).string();
+                if (error) {
+                    return false;
+                }
+                std::lock_guard lock(this->mutex);
+                return this->paths.insert(std::move(canonicalPath)).second;
+            }
+        };
+
+        template<typename Reader>
+        void scanNode(ScanNode &node, const RecursiveScanOptions &options, WorkStealingPool &pool,
+                      VisitedDirectories *visited) {
+            const EntryFilter filter(options.scan);
+            // Only built when there is a predicate to call
+            FileEntity file;
+            node.prefix = (std::filesystem::path(node.path) / "").string();
+            Reader reader(node.path);
+            while (reader.next()) {
+                // Directories rejected by the filters are still descended into, only their own entry is dropped
+                const bool descend = (options.maxDepth < 0 || node.depth < options.maxDepth) &&
+                                     reader.type() == FileType::DIRECTORY &&
+                                     (options.symlinks == SymlinkPolicy::Follow || !reader.isSymlink());
+                const bool accepted = filter.accepts(reader);
+                if (!accepted && !descend)
+                    continue;
+
+                const auto type = reader.type();
+                const auto size = type != FileType::DIRECTORY && options.scan.readSizes ? reader.size() : 0;
+                const auto modifiedTime = options.scan.readModifiedTimes ? reader.modifiedTime() : 0;
+                bool matched = accepted;
+                if (matched && options.predicate) {
+                    readEntry(reader, file, options.scan);
+                    matched = options.predicate(file);
+                }
+                if (matched || descend) {
+                    node.items.push_back({std::string(reader.name()), type, size, modifiedTime, matched,
+                                          descend ? std::make_unique<ScanNode>() : nullptr});
+                }
+            }
+
+            // Sorting here keeps the final order independent of which worker scanned what
+            std::ranges::sort(node.items, {}, [](const ScanNode::Item &item) -> const std::string & {
+                return item.name;
+            });
+
+            for (auto &item: node.items) {
+                if (!item.child)
+                    continue;
+                item.child->path = node.prefix + item.name;
+                if (visited && !visited->insert(item.child->path)) {
+                    item.child.reset();
+                    continue;
+                }
+                item.child->depth = node.depth + 1;
+                item.child->modifiedTime = item.modifiedTime;
+                pool.submit([&options, &pool, visited, child = item.child.get()] {
+                    try {
+                        scanNode<Reader>(*child, options, pool, visited);
+                    } catch (const std::filesystem::filesystem_error &e) {
+                        std::cerr << "Error scanning directory: " << e.what() << std::endl;
+                    }
+                });
+            }
+        }
+
+        void collectNode(ScanNode &node, std::vector<FileEntity> &files) {
+            for (auto &item: node.items) {
+                if (item.matched)
+                    files.emplace_back(item.name, node.prefix + item.name, item.type, item.size);
+                if (item.child)
+                    collectNode(*item.child, files);
+            }
+        }
+
+        void collectNode(const ScanNode &node, ScanResult &result) {
+            // Every scanned directory is listed, even without a matched entry, so the result knows what it covers
+            const auto directory = result.addDirectory(node.prefix, node.modifiedTime);
+            for (const auto &item: node.items) {
+                if (item.matched)
+                    result.add(directory, item.name, item.type, item.size, item.modifiedTime);
+                if (item.child)
+                    collectNode(*item.child, result);
+            }
+        }
+
+        template<typename Reader, typename Result>
+        Result scanTree(const std::string &path, const RecursiveScanOptions &options) {
+            ScanNode root;
+            root.path = path;
+            if (options.scan.readModifiedTimes) {
+                // Read before the directory is scanned, so a change made during the scan is never missed later
+                root.modifiedTime = DirectoryScanner::readModifiedTime(path);
+            }
+            VisitedDirectories visitedDirectories;
+            VisitedDirectories *visited = nullptr;
+            if (options.symlinks == SymlinkPolicy::Follow) {
+                visited = &visitedDirectories;
+                visited->insert(path);
+            }
+
+            WorkStealingPool pool(options.jobs);
+            pool.run([&] { scanNode<Reader>(root, options, pool, visited); });
+
+            Result result;
+            collectNode(root, result);
+            if constexpr (std::is_same_v<Result, ScanResult>) {
+                result.shrinkToFit();
+            }
+            return result;
+        }
+
+    } // namespace
+
+    std::vector<FileEntity> DirectoryScanner::scanDirectory(const std::string& path, const ScanOptions &options) {
         auto files = std::vector<FileEntity>();
-        for (const auto &entry : std::filesystem::directory_iterator(path)) {
-            auto file = FileEntity(entry.path().filename().string(),
-                                    entry.path().string(),
-                                    FileType::FILE,
-                                    0);
-            if (entry.is_directory())
-                file.type = FileType::DIRECTORY;
-            else
-                file.size = entry.file_size();
-            files.push_back(file);
+        for (auto &file : entries(path, options)) {
+            files.push_back(std::move(file));
         }
         return files;
     }
 
+    DirectoryRange DirectoryScanner::entries(const std::string &path, const ScanOptions &options) {
+#ifdef __linux__
+        if (options.backend == ScanBackend::Getdents)
+            return DirectoryRange(std::make_unique<BackendReader<GetdentsReader>>(path, options));
+#endif
+        return DirectoryRange(std::make_unique<BackendReader<PortableReader>>(path, options));
+    }
+
+    bool DirectoryScanner::containsEntry(const std::string &path,
+                                         const std::function<bool(std::string_view name)> &predicate) {
+#ifdef __linux__
+        return anyEntryName<GetdentsReader>(path, predicate);
+#else
+        return anyEntryName<PortableReader>(path, predicate);
+#endif
+    }
+
+    int64_t DirectoryScanner::readModifiedTime(const std::string &path) {
+        std::error_code error;
+        const auto time = std::filesystem::last_write_time(path, error);
+        if (error) {
+            return 0;
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::file_clock::to_sys(time).time_since_epoch())
+                .count();
+    }
+
+    bool DirectoryScanner::matchesGlob(const std::string_view pattern, const std::string_view name,
+                                       const bool ignoreCase) {
+        // Greedy matching that backtracks to the last star, linear for patterns with a single star
+        size_t patternIndex = 0;
+        size_t nameIndex = 0;
+        size_t starIndex = std::string_view::npos;
+        size_t starNameIndex = 0;
+        while (nameIndex < name.size()) {
+            if (patternIndex < pattern.size() && pattern[patternIndex] == '*') {
+                starIndex = patternIndex++;
+                starNameIndex = nameIndex;
+            } else if (patternIndex < pattern.size() &&
+                       (pattern[patternIndex] == '?' || pattern[patternIndex] == name[nameIndex] ||
+                        (ignoreCase && equalsIgnoreCase(pattern[patternIndex], name[nameIndex])))) {
+                ++patternIndex;
+                ++nameIndex;
+            } else if (starIndex != std::string_view::npos) {
+                patternIndex = starIndex + 1;
+                nameIndex = ++starNameIndex;
+            } else {
+                return false;
+            }
+        }
+        while (patternIndex < pattern.size() && pattern[patternIndex] == '*') {
+            ++patternIndex;
+        }
+        return patternIndex == pattern.size();
+    }
+
+    std::vector<FileEntity> DirectoryScanner::scanRecursive(const std::string &path,
+                                                            const RecursiveScanOptions &options) {
+#ifdef __linux__
+        if (options.scan.backend == ScanBackend::Getdents)
+            return scanTree<GetdentsReader, std::vector<FileEntity>>(path, options);
+#endif
+        return scanTree<PortableReader, std::vector<FileEntity>>(path, options);
+    }
+
+    ScanResult DirectoryScanner::scanRecursiveCompact(const std::string &path, const RecursiveScanOptions &options) {
+#ifdef __linux__
+        if (options.scan.backend == ScanBackend::Getdents)
+            return scanTree<GetdentsReader, ScanResult>(path, options);
+#endif
+        return scanTree<PortableReader, ScanResult>(path, options);
+    }
+
 } // DosboxStagingReplacer
@@ -5,14 +5,164 @@
 #ifndef DIRECTORYSCANNER_H
 #define DIRECTORYSCANNER_H
 
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
+#include <functional>
 
 #include "CoreHelperModels.h"
+#include "ScanResult.h"
 
 namespace DosboxStagingReplacer {
 
+    /**
+     * @brief The implementation used to read the entries of a directory.
+     */
+    enum class ScanBackend {
+        /// std::filesystem::directory_iterator, available on every platform
+        Portable,
+        /// Batched getdents64 reads trusting d_type, Linux only. Falls back to Portable elsewhere
+        Getdents,
+    };
+
+    /**
+     * @brief Returns the fastest backend available on the current platform.
+     */
+    constexpr ScanBackend defaultScanBackend() {
+#ifdef __linux__
+        return ScanBackend::Getdents;
+#else
+        return ScanBackend::Portable;
+#endif
+    }
+
+    /**
+     * @brief Options controlling how a directory is scanned.
+     *
+     * The filters are evaluated inside the scanner, cheapest first, before a FileEntity is built for the entry.
+     * Name filters only look at the name read from the directory, the size filter is the only one needing a stat.
+     */
+    struct ScanOptions {
+        ScanBackend backend = defaultScanBackend();
+        /// If false, file sizes are left at 0 and no stat call is needed for regular files
+        bool readSizes = true;
+        /// Also stat every entry for its modification time, only kept by scanRecursiveCompact
+        bool readModifiedTimes = false;
+        /// Only entries whose name matches one of these globs are returned. Supports * and ?, empty matches all
+        std::vector<std::string> nameGlobs;
+        /// Compare nameGlobs without regard to ASCII case
+        bool globsIgnoreCase = false;
+        /// Only entries whose name starts with one of these prefixes, compared literally so * and ? match themselves
+        std::vector<std::string> namePrefixes;
+        /// Only entries whose name ends with one of these suffixes, e.g. ".conf", compared without regard to case
+        std::vector<std::string> suffixes;
+        /// Only entries of this type, FileType::NONE returns both files and directories
+        FileType type = FileType::NONE;
+        /// Files outside of this size range are skipped, directories are never filtered by size
+        unsigned long minSize = 0;
+        unsigned long maxSize = std::numeric_limits<unsigned long>::max();
+    };
+
+    /**
+     * @brief How scanRecursive treats symbolic links to directories.
+     */
+    enum class SymlinkPolicy {
+        /// The link is listed like any other directory but its contents are not scanned
+        DoNotFollow,
+        /// The link is scanned, every directory is still scanned at most once so loops are harmless
+        Follow,
+    };
+
+    /**
+     * @brief Options controlling how a directory tree is scanned.
+     */
+    struct RecursiveScanOptions {
+        ScanOptions scan;
+        /// How many levels below the root are scanned, 0 only lists the root and a negative value has no limit
+        int maxDepth = -1;
+        SymlinkPolicy symlinks = SymlinkPolicy::DoNotFollow;
+        /// Evaluated by the workers, rejected entries are never stored. Rejected directories are still scanned
+        std::function<bool(const FileEntity &file)> predicate;
+        /// The number of directories scanned at the same time, 0 uses one per hardware thread
+        unsigned int jobs = 0;
+    };
+
+    /**
+     * @brief Source of the entries behind a DirectoryRange, there is one implementation per ScanBackend.
+     */
+    class DirectoryReader {
+    public:
+        virtual ~DirectoryReader() = default;
+
+        /**
+         * @brief Reads the next entry of the directory.
+         * @param file Receives the entry, its strings are reused between calls.
+         * @return false once the directory has no more entries.
+         */
+        virtual bool next(FileEntity &file) = 0;
+    };
+
+    /**
+     * @brief Single pass range over the entries of a directory.
+     *
+     * Entries are read on demand, so an algorithm that stops early, such as std::ranges::any_of or
+     * std::ranges::find_if, also stops reading the directory. The entry returned by the iterator is
+     * overwritten when the iterator is advanced, copy or move it out to keep it.
+     */
+    class DirectoryRange {
+        std::unique_ptr<DirectoryReader> reader;
+        FileEntity current;
+        bool started = false;
+        bool exhausted = false;
+
+        void advance() { this->exhausted = !this->reader->next(this->current); }
+
+    public:
+        class Iterator {
+            DirectoryRange *range = nullptr;
+
+        public:
+            using value_type = FileEntity;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+            explicit Iterator(DirectoryRange *range) : range(range) {}
+
+            FileEntity &operator*() const { return this->range->current; }
+            FileEntity *operator->() const { return &this->range->current; }
+
+            Iterator &operator++() {
+                this->range->advance();
+                return *this;
+            }
+            void operator++(int) { ++*this; }
+
+            [[nodiscard]] bool atEnd() const { return this->range == nullptr || this->range->exhausted; }
+
+            friend bool operator==(const Iterator &iterator, std::default_sentinel_t) { return iterator.atEnd(); }
+        };
+
+        explicit DirectoryRange(std::unique_ptr<DirectoryReader> reader) : reader(std::move(reader)) {}
+
+        /**
+         * @brief Reads the first entry, the range can only be iterated once.
+         */
+        Iterator begin() {
+            if (!this->started) {
+                this->started = true;
+                this->advance();
+            }
+            return Iterator(this);
+        }
+
+        [[nodiscard]] static std::default_sentinel_t end() { return std::default_sentinel; }
+    };
+
     /**
      * @brief Base class for scanning a directory.
      *
@@ -24,9 +174,68 @@ namespace DosboxStagingReplacer {
         /**
          * @brief Scans a directory and returns a list of files.
          * @param path The path to the directory.
+         * @param options The backend to use and the information to read for each entry.
          * @return A list of FileEntity objects found in the directory.
          */
-        static std::vector<FileEntity> scanDirectory(const std::string &path);
+        static std::vector<FileEntity> scanDirectory(const std::string &path, const ScanOptions &options = {});
+
+        /**
+         * @brief Returns a range reading the entries of a directory as it is iterated.
+         * @param path The path to the directory, it is opened right away.
+         * @param options The backend to use and the information to read for each entry.
+         * @return A single pass range of FileEntity objects.
+         */
+        static DirectoryRange entries(const std::string &path, const ScanOptions &options = {});
+
+        /**
+         * @brief Scans a directory and all of its subdirectories.
+         *
+         * Each directory is scanned as a separate task on a work-stealing pool. The result does not depend on
+         * the scheduling: entries are sorted by name and every directory is followed by its own contents.
+         * Subdirectories that cannot be read are reported and skipped, only an unreadable root throws.
+         *
+         * @param path The path to the root directory.
+         * @param options Depth, symbolic link, filtering and concurrency settings.
+         * @return The FileEntity objects found in the tree, in depth-first order.
+         */
+        static std::vector<FileEntity> scanRecursive(const std::string &path, const RecursiveScanOptions &options = {});
+
+        /**
+         * @brief Scans a directory tree like scanRecursive, but into a compact ScanResult.
+         *
+         * No FileEntity is built for the entries unless a predicate is set, and each directory path is stored
+         * once instead of being repeated in the path of every entry. Meant for large trees.
+         *
+         * @param path The path to the root directory.
+         * @param options Depth, symbolic link, filtering and concurrency settings.
+         * @return The entries found in the tree, in the same order as scanRecursive.
+         */
+        static ScanResult scanRecursiveCompact(const std::string &path, const RecursiveScanOptions &options = {});
+
+        /**
+         * @brief Checks whether any entry of a directory matches a predicate.
+         * Stops at the first match and never queries file sizes, so it is much cheaper than scanDirectory.
+         * @param path The path to the directory.
+         * @param predicate Receives the name of each entry.
+         * @return true if an entry matched, false otherwise.
+         */
+        static bool containsEntry(const std::string &path, const std::function<bool(std::string_view name)> &predicate);
+
+        /**
+         * @brief Matches a name against a glob where * matches any sequence and ? any single character.
+         * @param pattern The glob.
+         * @param name The name to match.
+         * @param ignoreCase Compare without regard to ASCII case.
+         * @return true if the whole name matches the glob.
+         */
+        static bool matchesGlob(std::string_view pattern, std::string_view name, bool ignoreCase = false);
+
+        /**
+         * @brief Reads the modification time of a file or directory, following symbolic links.
+         * @param path The path to read.
+         * @return Nanoseconds since the Unix epoch, 0 if the path cannot be read.
+         */
+        static int64_t readModifiedTime(const std::string &path);
     };
 
 } // namespace DosboxStagingReplacer
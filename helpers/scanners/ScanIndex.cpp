@@ -0,0 +1,414 @@
+#include "ScanIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include "DirectoryScanner.h"
+#include "OutputSink.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief A read only memory mapping of a whole file.
+     */
+    class MappedFile {
+    public:
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /**
+         * @brief Maps a file.
+         * @return The mapping, or nullptr if the file cannot be opened or is empty.
+         */
+        static std::unique_ptr<MappedFile> open(const std::string &path) {
+            auto mapped = std::unique_ptr<MappedFile>(new MappedFile());
+#ifdef _WIN32
+            mapped->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            LARGE_INTEGER fileSize;
+            if (mapped->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(mapped->file, &fileSize) ||
+                fileSize.QuadPart == 0) {
+                return nullptr;
+            }
+            mapped->length = static_cast<size_t>(fileSize.QuadPart);
+            mapped->mapping = CreateFileMappingA(mapped->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapped->mapping == nullptr) {
+                return nullptr;
+            }
+            mapped->address = static_cast<const char *>(MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                return nullptr;
+            }
+            struct stat status {};
+            if (fstat(fd, &status) != 0 || status.st_size == 0) {
+                close(fd);
+                return nullptr;
+            }
+            mapped->length = static_cast<size_t>(status.st_size);
+            // The mapping stays valid after the descriptor is closed
+            void *address = mmap(nullptr, mapped->length, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            mapped->address = address == MAP_FAILED ? nullptr : static_cast<const char *>(address);
+#endif
+            return mapped->address != nullptr ? std::move(mapped) : nullptr;
+        }
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (this->address != nullptr)
+                UnmapViewOfFile(this->address);
+            if (this->mapping != nullptr)
+                CloseHandle(this->mapping);
+            if (this->file != INVALID_HANDLE_VALUE)
+                CloseHandle(this->file);
+#else
+            if (this->address != nullptr)
+                munmap(const_cast<char *>(this->address), this->length);
+#endif
+        }
+
+        [[nodiscard]] const char *data() const { return this->address; }
+        [[nodiscard]] size_t size() const { return this->length; }
+
+    private:
+        const char *address = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+
+        MappedFile() = default;
+    };
+
+    /**
+     * @brief A directory of the index, its entries are entriesByDirectory[firstEntry, firstEntry + entryCount).
+     */
+    struct ScanIndex::Directory {
+        uint32_t pathOffset;
+        uint32_t pathLength;
+        uint32_t firstEntry;
+        uint32_t entryCount;
+        int64_t modifiedTime;
+    };
+
+    namespace {
+
+        constexpr char indexMagic[8] = {'D', 'S', 'R', 'S', 'C', 'A', 'N', '\0'};
+        // Written in the native byte order, an index saved on a machine with another byte order is rejected
+        constexpr uint32_t indexByteOrder = 0x01020304;
+
+        struct IndexHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint64_t fileSize;
+            uint64_t directoryCount;
+            uint64_t entryCount;
+            uint64_t poolSize;
+            uint32_t rootOffset;
+            uint32_t rootLength;
+        };
+
+        /**
+         * @brief Offsets of the arrays following the header, each one aligned to 8 bytes so they can be
+         * used in place once the file is mapped.
+         */
+        struct IndexLayout {
+            uint64_t directories;
+            uint64_t directoryOrder;
+            uint64_t entriesByDirectory;
+            uint64_t parents;
+            uint64_t nameOffsets;
+            uint64_t nameLengths;
+            uint64_t types;
+            uint64_t sizes;
+            uint64_t modifiedTimes;
+            uint64_t pool;
+            uint64_t end;
+
+            template<typename Directory>
+            static IndexLayout compute(const uint64_t directoryCount, const uint64_t entryCount,
+                                       const uint64_t poolSize) {
+                uint64_t offset = sizeof(IndexHeader);
+                const auto section = [&offset](const uint64_t bytes) {
+                    offset = (offset + 7) & ~uint64_t{7};
+                    const auto start = offset;
+                    offset += bytes;
+                    return start;
+                };
+                IndexLayout layout{};
+                layout.directories = section(directoryCount * sizeof(Directory));
+                layout.directoryOrder = section(directoryCount * sizeof(uint32_t));
+                layout.entriesByDirectory = section(entryCount * sizeof(uint32_t));
+                layout.parents = section(entryCount * sizeof(uint32_t));
+                layout.nameOffsets = section(entryCount * sizeof(uint32_t));
+                layout.nameLengths = section(entryCount * sizeof(uint16_t));
+                layout.types = section(entryCount * sizeof(int8_t));
+                layout.sizes = section(entryCount * sizeof(uint64_t));
+                layout.modifiedTimes = section(entryCount * sizeof(int64_t));
+                layout.pool = section(poolSize);
+                layout.end = offset;
+                return layout;
+            }
+        };
+
+        template<typename T>
+        void writeSection(OutputSink &file, uint64_t &written, const uint64_t offset, const T *data,
+                          const size_t count) {
+            // Pads up to the start of the section
+            static constexpr char zeros[8] = {};
+            file.write(std::string_view(zeros, offset - written));
+            file.write(std::string_view(reinterpret_cast<const char *>(data), count * sizeof(T)));
+            written = offset + count * sizeof(T);
+        }
+
+        bool isSeparator(const char character) {
+#ifdef _WIN32
+            return character == '/' || character == '\\';
+#else
+            return character == '/';
+#endif
+        }
+
+    } // namespace
+
+    ScanIndex::ScanIndex(ScanIndex &&) noexcept = default;
+    ScanIndex &ScanIndex::operator=(ScanIndex &&) noexcept = default;
+    ScanIndex::~ScanIndex() = default;
+
+    std::string_view ScanIndex::Entry::name() const {
+        return {this->index->pool + this->index->nameOffsets[this->position], this->index->nameLengths[this->position]};
+    }
+
+    std::string_view ScanIndex::Entry::directory() const {
+        return this->index->directoryPath(this->index->parents[this->position]);
+    }
+
+    std::string ScanIndex::Entry::path() const {
+        std::string entryPath;
+        const auto entryDirectory = this->directory();
+        const auto entryName = this->name();
+        entryPath.reserve(entryDirectory.size() + entryName.size());
+        entryPath.append(entryDirectory).append(entryName);
+        return entryPath;
+    }
+
+    FileType ScanIndex::Entry::type() const {
+        return static_cast<FileType>(this->index->types[this->position]);
+    }
+
+    unsigned long ScanIndex::Entry::size() const {
+        return static_cast<unsigned long>(this->index->sizes[this->position]);
+    }
+
+    int64_t ScanIndex::Entry::modifiedTime() const {
+        return this->index->modifiedTimes[this->position];
+    }
+
+    FileEntity ScanIndex::Entry::toFileEntity() const {
+        return FileEntity(std::string(this->name()), this->path(), this->type(), this->size());
+    }
+
+    std::string_view ScanIndex::directoryPath(const uint32_t directory) const {
+        return {this->pool + this->directories[directory].pathOffset, this->directories[directory].pathLength};
+    }
+
+    bool ScanIndex::save(const ScanResult &result, const std::string &rootPath, const std::string &indexPath) {
+        const auto directoryCount = static_cast<uint32_t>(result.directories.size());
+        const auto entryCount = static_cast<uint32_t>(result.parents.size());
+
+        // Entries grouped by directory and sorted by name, so lookups can binary search a directory
+        std::vector<uint32_t> entriesByDirectory(entryCount);
+        std::iota(entriesByDirectory.begin(), entriesByDirectory.end(), 0);
+        const auto nameOf = [&](const uint32_t entry) {
+            return std::string_view(result.pool.data() + result.nameOffsets[entry], result.nameLengths[entry]);
+        };
+        std::ranges::sort(entriesByDirectory, [&](const uint32_t left, const uint32_t right) {
+            if (result.parents[left] != result.parents[right])
+                return result.parents[left] < result.parents[right];
+            return nameOf(left) < nameOf(right);
+        });
+
+        std::vector<Directory> directories(directoryCount);
+        for (uint32_t directory = 0; directory < directoryCount; ++directory) {
+            directories[directory] = {result.directories[directory].offset, result.directories[directory].length, 0,
+                                      0, result.directoryModifiedTimes[directory]};
+        }
+        for (uint32_t position = 0; position < entryCount; ++position) {
+            auto &directory = directories[result.parents[entriesByDirectory[position]]];
+            if (directory.entryCount++ == 0)
+                directory.firstEntry = position;
+        }
+
+        std::vector<uint32_t> directoryOrder(directoryCount);
+        std::iota(directoryOrder.begin(), directoryOrder.end(), 0);
+        std::ranges::sort(directoryOrder, {}, [&](const uint32_t directory) { return result.getDirectory(directory); });
+
+        // The root path is kept after the strings of the scan
+        std::string pool = result.pool;
+        IndexHeader header{};
+        std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+        header.version = formatVersion;
+        header.byteOrder = indexByteOrder;
+        header.directoryCount = directoryCount;
+        header.entryCount = entryCount;
+        header.rootOffset = static_cast<uint32_t>(pool.size());
+        header.rootLength = static_cast<uint32_t>(rootPath.size());
+        pool.append(rootPath);
+        header.poolSize = pool.size();
+        const auto layout = IndexLayout::compute<Directory>(directoryCount, entryCount, header.poolSize);
+        header.fileSize = layout.end;
+
+        try {
+            AtomicFileSink file(indexPath);
+            uint64_t written = 0;
+            writeSection(file, written, 0, &header, 1);
+            writeSection(file, written, layout.directories, directories.data(), directories.size());
+            writeSection(file, written, layout.directoryOrder, directoryOrder.data(), directoryOrder.size());
+            writeSection(file, written, layout.entriesByDirectory, entriesByDirectory.data(),
+                         entriesByDirectory.size());
+            writeSection(file, written, layout.parents, result.parents.data(), result.parents.size());
+            writeSection(file, written, layout.nameOffsets, result.nameOffsets.data(), result.nameOffsets.size());
+            writeSection(file, written, layout.nameLengths, result.nameLengths.data(), result.nameLengths.size());
+            writeSection(file, written, layout.types, result.types.data(), result.types.size());
+            writeSection(file, written, layout.sizes, result.sizes.data(), result.sizes.size());
+            writeSection(file, written, layout.modifiedTimes, result.modifiedTimes.data(),
+                         result.modifiedTimes.size());
+            writeSection(file, written, layout.pool, pool.data(), pool.size());
+            file.finish();
+        } catch (const std::exception &e) {
+            std::cerr << "Error: Could not write scan index " << indexPath << ": " << e.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<ScanIndex> ScanIndex::load(const std::string &indexPath, const std::string &rootPath) {
+        auto mapping = MappedFile::open(indexPath);
+        if (!mapping || mapping->size() < sizeof(IndexHeader)) {
+            return std::nullopt;
+        }
+
+        IndexHeader header{};
+        std::memcpy(&header, mapping->data(), sizeof(header));
+        if (std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0 || header.version != formatVersion ||
+            header.byteOrder != indexByteOrder || header.fileSize != mapping->size() ||
+            header.directoryCount > mapping->size() || header.entryCount > mapping->size() ||
+            header.poolSize > mapping->size()) {
+            return std::nullopt;
+        }
+        const auto layout = IndexLayout::compute<Directory>(header.directoryCount, header.entryCount, header.poolSize);
+        if (layout.end != header.fileSize ||
+            static_cast<uint64_t>(header.rootOffset) + header.rootLength > header.poolSize) {
+            return std::nullopt;
+        }
+
+        ScanIndex index;
+        const char *base = mapping->data();
+        index.pool = base + layout.pool;
+        index.directories = reinterpret_cast<const Directory *>(base + layout.directories);
+        index.directoryOrder = reinterpret_cast<const uint32_t *>(base + layout.directoryOrder);
+        index.entriesByDirectory = reinterpret_cast<const uint32_t *>(base + layout.entriesByDirectory);
+        index.parents = reinterpret_cast<const uint32_t *>(base + layout.parents);
+        index.nameOffsets = reinterpret_cast<const uint32_t *>(base + layout.nameOffsets);
+        index.nameLengths = reinterpret_cast<const uint16_t *>(base + layout.nameLengths);
+        index.types = reinterpret_cast<const int8_t *>(base + layout.types);
+        index.sizes = reinterpret_cast<const uint64_t *>(base + layout.sizes);
+        index.modifiedTimes = reinterpret_cast<const int64_t *>(base + layout.modifiedTimes);
+        index.directoryCount = header.directoryCount;
+        index.entryCount = header.entryCount;
+        index.mapping = std::move(mapping);
+
+        if (std::string_view(index.pool + header.rootOffset, header.rootLength) != rootPath) {
+            return std::nullopt;
+        }
+
+        // Every offset is checked once here so that lookups never read outside of the mapping
+        for (size_t entry = 0; entry < index.entryCount; ++entry) {
+            if (index.parents[entry] >= index.directoryCount || index.entriesByDirectory[entry] >= index.entryCount ||
+                static_cast<uint64_t>(index.nameOffsets[entry]) + index.nameLengths[entry] > header.poolSize) {
+                return std::nullopt;
+            }
+        }
+        for (size_t directory = 0; directory < index.directoryCount; ++directory) {
+            const auto &[pathOffset, pathLength, firstEntry, entryCount, modifiedTime] = index.directories[directory];
+            if (index.directoryOrder[directory] >= index.directoryCount ||
+                static_cast<uint64_t>(pathOffset) + pathLength > header.poolSize ||
+                static_cast<uint64_t>(firstEntry) + entryCount > index.entryCount) {
+                return std::nullopt;
+            }
+        }
+
+        // Only the directories are looked at, their contents are never read
+        for (size_t directory = 0; directory < index.directoryCount; ++directory) {
+            const auto path = std::string(index.directoryPath(static_cast<uint32_t>(directory)));
+            if (DirectoryScanner::readModifiedTime(path) != index.directories[directory].modifiedTime) {
+                return std::nullopt;
+            }
+        }
+        return index;
+    }
+
+    std::optional<uint32_t> ScanIndex::findDirectory(const std::string_view path) const {
+        const auto *end = this->directoryOrder + this->directoryCount;
+        const auto *found = std::lower_bound(this->directoryOrder, end, path, [&](const uint32_t directory, const auto &value) {
+            return this->directoryPath(directory) < value;
+        });
+        if (found == end || this->directoryPath(*found) != path) {
+            return std::nullopt;
+        }
+        return *found;
+    }
+
+    std::optional<ScanIndex::Entry> ScanIndex::find(const std::string_view path) const {
+        size_t separator = path.size();
+        while (separator > 0 && !isSeparator(path[separator - 1])) {
+            --separator;
+        }
+        const auto directory = this->findDirectory(path.substr(0, separator));
+        if (!directory) {
+            return std::nullopt;
+        }
+
+        const auto name = path.substr(separator);
+        const auto &[pathOffset, pathLength, firstEntry, entryCount, modifiedTime] = this->directories[*directory];
+        const auto *begin = this->entriesByDirectory + firstEntry;
+        const auto *end = begin + entryCount;
+        const auto *found = std::lower_bound(begin, end, name, [&](const uint32_t entry, const auto &value) {
+            return Entry(this, entry).name() < value;
+        });
+        if (found == end || Entry(this, *found).name() != name) {
+            return std::nullopt;
+        }
+        return Entry(this, *found);
+    }
+
+    std::vector<FileEntity> ScanIndex::listDirectory(const std::string &path) const {
+        auto files = std::vector<FileEntity>();
+        const auto directory = this->findDirectory((std::filesystem::path(path) / "").string());
+        if (!directory) {
+            return files;
+        }
+        const auto &[pathOffset, pathLength, firstEntry, entryCount, modifiedTime] = this->directories[*directory];
+        files.reserve(entryCount);
+        for (uint32_t position = firstEntry; position < firstEntry + entryCount; ++position) {
+            files.push_back(Entry(this, this->entriesByDirectory[position]).toFileEntity());
+        }
+        return files;
+    }
+
+} // namespace DosboxStagingReplacer
@@ -0,0 +1,136 @@
+#ifndef SCANINDEX_H
+#define SCANINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CoreHelperModels.h"
+#include "ScanResult.h"
+
+namespace DosboxStagingReplacer {
+
+    class MappedFile;
+
+    /**
+     * @brief A ScanResult saved to disk and memory mapped back, so a later run can answer lookups without
+     * reading the directories again.
+     *
+     * The file is a versioned header followed by the arrays of the ScanResult, each at a fixed offset, so
+     * loading only maps the file and checks its bounds. An index is only returned by load while every
+     * directory it covers still has the modification time recorded during the scan. Adding, removing or
+     * renaming an entry changes the time of its directory, rewriting a file in place does not, so sizes and
+     * times of files can be out of date.
+     *
+     * Meant for recursive scans of large trees, such as a whole game library. A single directory is read
+     * faster than an index covering it can be validated.
+     */
+    class ScanIndex {
+    public:
+        /// Bumped whenever the layout of the file changes, older files are ignored by load
+        static constexpr uint32_t formatVersion = 1;
+
+        /**
+         * @brief View of a single entry, only valid while the ScanIndex it comes from is alive.
+         */
+        class Entry {
+            const ScanIndex *index;
+            uint32_t position;
+
+        public:
+            Entry(const ScanIndex *index, const uint32_t position) : index(index), position(position) {}
+
+            [[nodiscard]] std::string_view name() const;
+            /// The directory containing the entry, including the trailing separator
+            [[nodiscard]] std::string_view directory() const;
+            [[nodiscard]] std::string path() const;
+            [[nodiscard]] FileType type() const;
+            [[nodiscard]] unsigned long size() const;
+            /// Nanoseconds since the Unix epoch
+            [[nodiscard]] int64_t modifiedTime() const;
+
+            [[nodiscard]] bool isFile() const { return this->type() == FileType::FILE; }
+            [[nodiscard]] bool isDirectory() const { return this->type() == FileType::DIRECTORY; }
+
+            /**
+             * @brief Copies the entry into a FileEntity.
+             */
+            [[nodiscard]] FileEntity toFileEntity() const;
+        };
+
+        ScanIndex(ScanIndex &&) noexcept;
+        ScanIndex &operator=(ScanIndex &&) noexcept;
+        ~ScanIndex();
+
+        /**
+         * @brief Writes a scan to an index file, replacing any previous index at once.
+         * The result must come from a scan with ScanOptions::readModifiedTimes, otherwise it never validates.
+         * @param result The scan to save.
+         * @param rootPath The directory that was scanned, load only accepts the index for the same path.
+         * @param indexPath The index file to write.
+         * @return true if the index was written, false otherwise.
+         */
+        static bool save(const ScanResult &result, const std::string &rootPath, const std::string &indexPath);
+
+        /**
+         * @brief Maps an index file and checks that it is still up to date.
+         * @param indexPath The index file to read.
+         * @param rootPath The directory the index must have been saved for.
+         * @return The index, or nothing if the file is missing, of another version or root, damaged, or if a
+         * directory it covers has changed since.
+         */
+        static std::optional<ScanIndex> load(const std::string &indexPath, const std::string &rootPath);
+
+        [[nodiscard]] size_t size() const { return this->entryCount; }
+        [[nodiscard]] bool empty() const { return this->entryCount == 0; }
+        [[nodiscard]] size_t getDirectoryCount() const { return this->directoryCount; }
+
+        /**
+         * @brief Returns an entry, entries keep the order of the ScanResult that was saved.
+         */
+        [[nodiscard]] Entry operator[](const size_t position) const { return {this, static_cast<uint32_t>(position)}; }
+
+        /**
+         * @brief Finds an entry by its full path, in logarithmic time.
+         * @param path The path as built by the scan, the directory followed by the name.
+         * @return The entry, or nothing if the index has no such entry.
+         */
+        [[nodiscard]] std::optional<Entry> find(std::string_view path) const;
+
+        /**
+         * @brief Lists the entries of a directory, like DirectoryScanner::scanDirectory but sorted by name.
+         * @param path The directory, with or without the trailing separator.
+         * @return The entries, empty if the directory is not part of the index.
+         */
+        [[nodiscard]] std::vector<FileEntity> listDirectory(const std::string &path) const;
+
+    private:
+        struct Directory;
+
+        std::unique_ptr<MappedFile> mapping;
+        const char *pool = nullptr;
+        const Directory *directories = nullptr;
+        const uint32_t *directoryOrder = nullptr;
+        const uint32_t *entriesByDirectory = nullptr;
+        const uint32_t *parents = nullptr;
+        const uint32_t *nameOffsets = nullptr;
+        const uint16_t *nameLengths = nullptr;
+        const int8_t *types = nullptr;
+        const uint64_t *sizes = nullptr;
+        const int64_t *modifiedTimes = nullptr;
+        size_t directoryCount = 0;
+        size_t entryCount = 0;
+
+        ScanIndex() = default;
+
+        [[nodiscard]] std::string_view directoryPath(uint32_t directory) const;
+        [[nodiscard]] std::optional<uint32_t> findDirectory(std::string_view path) const;
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // SCANINDEX_H
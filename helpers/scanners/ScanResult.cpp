@@ -0,0 +1,109 @@
+#include "ScanResult.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace DosboxStagingReplacer {
+
+    std::string_view ScanResult::Entry::name() const {
+        return {this->result->pool.data() + this->result->nameOffsets[this->index],
+                this->result->nameLengths[this->index]};
+    }
+
+    std::string_view ScanResult::Entry::directory() const {
+        return this->result->getDirectory(this->result->parents[this->index]);
+    }
+
+    std::string ScanResult::Entry::path() const {
+        std::string entryPath;
+        const auto entryDirectory = this->directory();
+        const auto entryName = this->name();
+        entryPath.reserve(entryDirectory.size() + entryName.size());
+        entryPath.append(entryDirectory).append(entryName);
+        return entryPath;
+    }
+
+    FileType ScanResult::Entry::type() const {
+        return static_cast<FileType>(this->result->types[this->index]);
+    }
+
+    unsigned long ScanResult::Entry::size() const {
+        return static_cast<unsigned long>(this->result->sizes[this->index]);
+    }
+
+    int64_t ScanResult::Entry::modifiedTime() const {
+        return this->result->modifiedTimes[this->index];
+    }
+
+    FileEntity ScanResult::Entry::toFileEntity() const {
+        return FileEntity(std::string(this->name()), this->path(), this->type(), this->size());
+    }
+
+    uint32_t ScanResult::appendToPool(const std::string_view text) {
+        if (this->pool.size() + text.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("ScanResult string pool is full");
+        }
+        const auto offset = static_cast<uint32_t>(this->pool.size());
+        this->pool.append(text);
+        return offset;
+    }
+
+    uint32_t ScanResult::addDirectory(const std::string_view path, const int64_t modifiedTime) {
+        const auto offset = this->appendToPool(path);
+        this->directories.push_back({offset, static_cast<uint32_t>(path.size())});
+        this->directoryModifiedTimes.push_back(modifiedTime);
+        return static_cast<uint32_t>(this->directories.size() - 1);
+    }
+
+    std::string_view ScanResult::getDirectory(const size_t directory) const {
+        const auto &[offset, length] = this->directories[directory];
+        return {this->pool.data() + offset, length};
+    }
+
+    int64_t ScanResult::getDirectoryModifiedTime(const size_t directory) const {
+        return this->directoryModifiedTimes[directory];
+    }
+
+    void ScanResult::add(const uint32_t directory, const std::string_view name, const FileType type,
+                         const unsigned long size, const int64_t modifiedTime) {
+        if (name.size() > std::numeric_limits<uint16_t>::max()) {
+            throw std::length_error("ScanResult entry name is too long");
+        }
+        this->nameOffsets.push_back(this->appendToPool(name));
+        this->nameLengths.push_back(static_cast<uint16_t>(name.size()));
+        this->parents.push_back(directory);
+        this->types.push_back(static_cast<int8_t>(type));
+        this->sizes.push_back(size);
+        this->modifiedTimes.push_back(modifiedTime);
+    }
+
+    std::vector<FileEntity> ScanResult::toFileEntities() const {
+        auto files = std::vector<FileEntity>();
+        files.reserve(this->size());
+        for (const auto &entry: *this) {
+            files.push_back(entry.toFileEntity());
+        }
+        return files;
+    }
+
+    size_t ScanResult::getMemoryUsage() const {
+        return sizeof(*this) + this->pool.capacity() + this->directories.capacity() * sizeof(PoolString) +
+               this->directoryModifiedTimes.capacity() * sizeof(int64_t) +
+               this->parents.capacity() * sizeof(uint32_t) + this->nameOffsets.capacity() * sizeof(uint32_t) +
+               this->nameLengths.capacity() * sizeof(uint16_t) + this->types.capacity() * sizeof(int8_t) +
+               this->sizes.capacity() * sizeof(uint64_t) + this->modifiedTimes.capacity() * sizeof(int64_t);
+    }
+
+    void ScanResult::shrinkToFit() {
+        this->pool.shrink_to_fit();
+        this->directories.shrink_to_fit();
+        this->directoryModifiedTimes.shrink_to_fit();
+        this->parents.shrink_to_fit();
+        this->nameOffsets.shrink_to_fit();
+        this->nameLengths.shrink_to_fit();
+        this->types.shrink_to_fit();
+        this->sizes.shrink_to_fit();
+        this->modifiedTimes.shrink_to_fit();
+    }
+
+} // namespace DosboxStagingReplacer
@@ -0,0 +1,146 @@
+#ifndef SCANRESULT_H
+#define SCANRESULT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CoreHelperModels.h"
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Compact storage for the entries of a large scan.
+     *
+     * Each directory path is stored once in a table of parents, names live back to back in a single string
+     * pool and the remaining fields are kept as one array per field. An entry costs a few dozen bytes plus its
+     * name, against two strings and a padded FileEntity otherwise. Entries are read through Entry, a view
+     * that can be turned back into a FileEntity for code expecting one.
+     */
+    class ScanResult {
+    public:
+        /**
+         * @brief View of a single entry, only valid while the ScanResult it comes from is alive and unchanged.
+         */
+        class Entry {
+            const ScanResult *result;
+            size_t index;
+
+        public:
+            Entry(const ScanResult *result, const size_t index) : result(result), index(index) {}
+
+            [[nodiscard]] std::string_view name() const;
+            /// The directory containing the entry, including the trailing separator
+            [[nodiscard]] std::string_view directory() const;
+            [[nodiscard]] std::string path() const;
+            [[nodiscard]] FileType type() const;
+            [[nodiscard]] unsigned long size() const;
+            /// Nanoseconds since the Unix epoch, 0 unless the scan read modification times
+            [[nodiscard]] int64_t modifiedTime() const;
+
+            [[nodiscard]] bool isFile() const { return this->type() == FileType::FILE; }
+            [[nodiscard]] bool isDirectory() const { return this->type() == FileType::DIRECTORY; }
+
+            /**
+             * @brief Copies the entry into a FileEntity.
+             */
+            [[nodiscard]] FileEntity toFileEntity() const;
+        };
+
+        class Iterator {
+            const ScanResult *result = nullptr;
+            size_t index = 0;
+
+        public:
+            using value_type = Entry;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+            Iterator(const ScanResult *result, const size_t index) : result(result), index(index) {}
+
+            Entry operator*() const { return {this->result, this->index}; }
+
+            Iterator &operator++() {
+                ++this->index;
+                return *this;
+            }
+            Iterator operator++(int) {
+                auto previous = *this;
+                ++this->index;
+                return previous;
+            }
+
+            bool operator==(const Iterator &other) const { return this->index == other.index; }
+        };
+
+        /**
+         * @brief Adds a directory that entries can be added to.
+         * @param path The directory path including the trailing separator, so that path + name is the entry path.
+         * @param modifiedTime The modification time of the directory in nanoseconds since the Unix epoch.
+         * @return The index of the directory, to pass to add.
+         */
+        uint32_t addDirectory(std::string_view path, int64_t modifiedTime = 0);
+
+        /**
+         * @brief Adds an entry.
+         * @param directory The index returned by addDirectory for the directory containing the entry.
+         * @param name The name of the entry.
+         * @param type The type of the entry.
+         * @param size The size in bytes.
+         * @param modifiedTime The modification time in nanoseconds since the Unix epoch.
+         */
+        void add(uint32_t directory, std::string_view name, FileType type, unsigned long size, int64_t modifiedTime);
+
+        [[nodiscard]] size_t size() const { return this->parents.size(); }
+        [[nodiscard]] bool empty() const { return this->parents.empty(); }
+        [[nodiscard]] size_t getDirectoryCount() const { return this->directories.size(); }
+        /// The path of a directory, including the trailing separator
+        [[nodiscard]] std::string_view getDirectory(size_t directory) const;
+        [[nodiscard]] int64_t getDirectoryModifiedTime(size_t directory) const;
+
+        [[nodiscard]] Entry operator[](const size_t index) const { return {this, index}; }
+        [[nodiscard]] Iterator begin() const { return {this, 0}; }
+        [[nodiscard]] Iterator end() const { return {this, this->size()}; }
+
+        /**
+         * @brief Copies every entry into a FileEntity, in the order they were added.
+         */
+        [[nodiscard]] std::vector<FileEntity> toFileEntities() const;
+
+        /**
+         * @brief Returns the number of bytes allocated by the container.
+         */
+        [[nodiscard]] size_t getMemoryUsage() const;
+
+        /**
+         * @brief Releases the capacity left over once every entry has been added.
+         */
+        void shrinkToFit();
+
+    private:
+        friend class ScanIndex;
+
+        struct PoolString {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        std::string pool;
+        std::vector<PoolString> directories;
+        std::vector<int64_t> directoryModifiedTimes;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> nameOffsets;
+        std::vector<uint16_t> nameLengths;
+        std::vector<int8_t> types;
+        std::vector<uint64_t> sizes;
+        std::vector<int64_t> modifiedTimes;
+
+        uint32_t appendToPool(std::string_view text);
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // SCANRESULT_H
@@ -0,0 +1,189 @@
+#include "WatchedScanCache.h"
+
+#include <filesystem>
+#include <iostream>
+#include <ranges>
+#include "DirectoryScanner.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace DosboxStagingReplacer {
+
+#ifdef __linux__
+    namespace {
+        // Every change that can add, remove, retype or resize an entry, plus the directory itself going away
+        constexpr uint32_t watchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY |
+                                       IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+    } // namespace
+#endif
+
+    WatchedScanCache::WatchedScanCache() {
+#ifdef __linux__
+        this->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (this->inotifyFd < 0) {
+            std::cerr << "Warning: Could not watch directories, every scan will read the directory: "
+                      << std::strerror(errno) << std::endl;
+        }
+#endif
+    }
+
+    WatchedScanCache::~WatchedScanCache() {
+#ifdef __linux__
+        if (this->inotifyFd >= 0) {
+            close(this->inotifyFd);
+        }
+#endif
+    }
+
+    WatchedScanCache::Listing WatchedScanCache::scanDirectory(const std::string &path) {
+        std::lock_guard lock(this->mutex);
+        this->applyEvents();
+
+        if (const auto known = this->watchesByPath.find(path); known != this->watchesByPath.end()) {
+            return listingOf(*this->directoriesByWatch.at(known->second));
+        }
+
+        int watch = -1;
+#ifdef __linux__
+        // The watch is added before the directory is read so that no change can fall in between
+        if (this->inotifyFd >= 0) {
+            watch = inotify_add_watch(this->inotifyFd, path.c_str(), watchMask);
+        }
+#endif
+        this->scanCount++;
+        std::vector<FileEntity> files;
+        try {
+            files = DirectoryScanner::scanDirectory(path);
+        } catch (...) {
+#ifdef __linux__
+            if (watch >= 0 && !this->directoriesByWatch.contains(watch))
+                inotify_rm_watch(this->inotifyFd, watch);
+#endif
+            throw;
+        }
+        // A directory reached through another path shares its watch, it is not cached twice
+        if (watch < 0 || this->directoriesByWatch.contains(watch)) {
+            return std::make_shared<const std::vector<FileEntity>>(std::move(files));
+        }
+
+        auto directory = std::make_unique<CachedDirectory>();
+        directory->path = path;
+        directory->prefix = (std::filesystem::path(path) / "").string();
+        directory->watch = watch;
+        for (auto &file: files) {
+            auto name = file.name;
+            directory->entries.insert_or_assign(std::move(name), std::move(file));
+        }
+        this->watchesByPath[path] = watch;
+        return listingOf(*(this->directoriesByWatch[watch] = std::move(directory)));
+    }
+
+    WatchedScanCache::Listing WatchedScanCache::listingOf(CachedDirectory &directory) {
+        // Rebuilt once after a change, then shared by every call until the next change
+        if (!directory.listing) {
+            auto files = std::make_shared<std::vector<FileEntity>>();
+            files->reserve(directory.entries.size());
+            for (const auto &file: directory.entries | std::views::values) {
+                files->push_back(file);
+            }
+            directory.listing = std::move(files);
+        }
+        return directory.listing;
+    }
+
+    void WatchedScanCache::applyEvents() {
+#ifdef __linux__
+        if (this->inotifyFd < 0) {
+            return;
+        }
+        alignas(inotify_event) char buffer[16 * 1024];
+        while (true) {
+            const auto length = read(this->inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                // EAGAIN once the queue is drained
+                return;
+            }
+            for (ssize_t offset = 0; offset < length;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    // Events were lost, nothing cached can be trusted any more
+                    this->forgetAll();
+                    continue;
+                }
+                const auto found = this->directoriesByWatch.find(event->wd);
+                if (found == this->directoriesByWatch.end()) {
+                    continue;
+                }
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                    this->forget(event->wd);
+                } else if (event->len > 0) {
+                    this->refreshEntry(*found->second, event->name);
+                }
+            }
+        }
+#endif
+    }
+
+    void WatchedScanCache::refreshEntry(CachedDirectory &directory, const std::string_view name) {
+        directory.listing.reset();
+        const auto existing = directory.entries.find(name);
+
+        // Read the same way the scanner does: links are followed, broken links are listed as empty files
+        FileEntity file(std::string(name), directory.prefix + std::string(name));
+        std::error_code error;
+        if (const auto linkStatus = std::filesystem::symlink_status(file.path, error);
+            error || !std::filesystem::exists(linkStatus)) {
+            if (existing != directory.entries.end())
+                directory.entries.erase(existing);
+            return;
+        }
+        file.type = std::filesystem::is_directory(file.path, error) ? FileType::DIRECTORY : FileType::FILE;
+        if (file.type == FileType::FILE) {
+            const auto size = std::filesystem::file_size(file.path, error);
+            file.size = error ? 0 : size;
+        }
+
+        if (existing != directory.entries.end()) {
+            existing->second = std::move(file);
+        } else {
+            directory.entries.emplace(std::string(name), std::move(file));
+        }
+    }
+
+    void WatchedScanCache::forget(const int watch) {
+        const auto found = this->directoriesByWatch.find(watch);
+        if (found == this->directoriesByWatch.end()) {
+            return;
+        }
+#ifdef __linux__
+        // Removing a watch the kernel already dropped fails harmlessly
+        inotify_rm_watch(this->inotifyFd, watch);
+#endif
+        this->watchesByPath.erase(found->second->path);
+        this->directoriesByWatch.erase(found);
+    }
+
+    void WatchedScanCache::forgetAll() {
+        while (!this->directoriesByWatch.empty()) {
+            this->forget(this->directoriesByWatch.begin()->first);
+        }
+    }
+
+    size_t WatchedScanCache::getScanCount() const {
+        std::lock_guard lock(this->mutex);
+        return this->scanCount;
+    }
+
+    size_t WatchedScanCache::getWatchedCount() const {
+        std::lock_guard lock(this->mutex);
+        return this->directoriesByWatch.size();
+    }
+
+} // namespace DosboxStagingReplacer
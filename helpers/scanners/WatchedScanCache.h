@@ -0,0 +1,78 @@
+#ifndef WATCHEDSCANCACHE_H
+#define WATCHEDSCANCACHE_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "CoreHelperModels.h"
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Keeps the listings of scanned directories up to date for processes that scan the same
+     * directories again and again.
+     *
+     * On Linux every cached directory is watched with inotify. Pending events are applied at the start of
+     * each call, one entry at a time, so a directory is only read once and an unchanged directory is answered
+     * without touching the file system beyond draining the event queue. If the kernel drops events the whole
+     * cache is discarded, it never serves a listing it cannot vouch for. Elsewhere, and for directories that
+     * cannot be watched, every call scans the directory.
+     */
+    class WatchedScanCache {
+    public:
+        using Listing = std::shared_ptr<const std::vector<FileEntity>>;
+
+        WatchedScanCache();
+        ~WatchedScanCache();
+
+        WatchedScanCache(const WatchedScanCache &) = delete;
+        WatchedScanCache &operator=(const WatchedScanCache &) = delete;
+
+        /**
+         * @brief Returns the entries of a directory, the same ones DirectoryScanner::scanDirectory would, sorted by name.
+         * @param path The path to the directory.
+         * @return The listing, it is never modified afterwards and stays valid as long as it is held.
+         */
+        Listing scanDirectory(const std::string &path);
+
+        /**
+         * @brief Returns the number of times a directory was actually read.
+         */
+        [[nodiscard]] size_t getScanCount() const;
+
+        /**
+         * @brief Returns the number of directories currently cached and watched.
+         */
+        [[nodiscard]] size_t getWatchedCount() const;
+
+    private:
+        struct CachedDirectory {
+            std::string path;
+            std::string prefix;
+            int watch = -1;
+            std::map<std::string, FileEntity, std::less<>> entries;
+            Listing listing;
+        };
+
+        mutable std::mutex mutex;
+        int inotifyFd = -1;
+        std::unordered_map<int, std::unique_ptr<CachedDirectory>> directoriesByWatch;
+        std::unordered_map<std::string, int> watchesByPath;
+        size_t scanCount = 0;
+
+        static Listing listingOf(CachedDirectory &directory);
+        void applyEvents();
+        void refreshEntry(CachedDirectory &directory, std::string_view name);
+        void forget(int watch);
+        void forgetAll();
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // WATCHEDSCANCACHE_H
@@ -5,34 +5,52 @@
 #ifndef STATEMENTPARSER_H
 #define STATEMENTPARSER_H
 
-#include <any>
-#include <memory>
+#include <cstdint>
 #include <string>
-#include <utility>
+#include <string_view>
+#include <tuple>
 #include <vector>
+#include "SqlSchema.h"
 #include "SqlService.h"
 
 namespace DosboxStagingReplacer {
 
-    enum class DataResultDataType { Number, String, Boolean };
-
     /**
-     * @brief Abstract base class for statement parsers.
-     * Provides an interface for parsing SQL statements into data objects.
+     * @brief Receives the attributes of a SqlDataResult with their native types.
+     * Lets exporters write values directly instead of going through their string representation.
      */
-    class SqlDataResult {
+    class SqlAttributeVisitor {
     public:
-        virtual ~SqlDataResult() = default;
+        virtual ~SqlAttributeVisitor() = default;
+
+        /**
+         * @brief Visits a numeric attribute.
+         * @param name The attribute name.
+         * @param value The attribute value.
+         */
+        virtual void visit(std::string_view name, int64_t value) = 0;
+
+        /**
+         * @brief Visits a boolean attribute.
+         * @param name The attribute name.
+         * @param value The attribute value.
+         */
+        virtual void visit(std::string_view name, bool value) = 0;
 
         /**
-         * Fills the object with the data from the statement.
-         *
-         * @param stmt The statement to fill the object with.
-         * @param parameters The parameters to fill the object with.
-         * @param engine The engine to use to fill the object.
-         * @return std::any
+         * @brief Visits a text attribute.
+         * @param name The attribute name.
+         * @param value The attribute value, only valid for the duration of the call.
          */
-        virtual std::any fillFromStatement(std::any stmt, std::vector<std::string> parameters, SqlEngine engine);
+        virtual void visit(std::string_view name, std::string_view value) = 0;
+    };
+
+    /**
+     * @brief Abstract base class for the data returned by SQL queries.
+     */
+    class SqlDataResult {
+    public:
+        virtual ~SqlDataResult() = default;
 
         /**
          * Returns all attributes of the class and their values.
@@ -42,6 +60,12 @@ namespace DosboxStagingReplacer {
         getAttributes() const {
             return {};
         }
+
+        /**
+         * Passes every attribute of the class to a visitor, in declaration order.
+         * Classes without attributes pass nothing.
+         */
+        virtual void visitAttributes(SqlAttributeVisitor &) const {}
     };
 
     class SqlDataResultException final : public std::exception {
@@ -57,40 +81,68 @@ namespace DosboxStagingReplacer {
     };
 
     /**
-     * @brief SqliteLastRowId class. Contains the information about the last row id.
+     * @brief Base class for SqlDataResult models described by SqlField descriptors.
+     *
+     * The derived class only declares its members and a static constexpr fields() function,
+     * decoding, binding and exporting are all derived from that table.
+     *
+     * @tparam T The derived model.
      */
-    class SqliteLastRowId final : public SqlDataResult {
-        using SqlDataResult::SqlDataResult;
+    template<typename T>
+    class SqlDataResultModel : public SqlDataResult {
+    public:
+        //! \copydoc DosboxStagingReplacer::SqlDataResult::getAttributes
+        [[nodiscard]] std::vector<std::tuple<std::string, std::string, DataResultDataType>>
+        getAttributes() const override {
+            std::vector<std::tuple<std::string, std::string, DataResultDataType>> attributes;
+            forEachSqlField<T>([&]<typename M>(const SqlField<T, M> &field) {
+                const M &value = static_cast<const T &>(*this).*field.member;
+                if constexpr (std::is_same_v<M, bool>) {
+                    attributes.emplace_back(field.name, value ? "true" : "false", sqlFieldDataType<M>());
+                } else if constexpr (std::is_integral_v<M>) {
+                    attributes.emplace_back(field.name, std::to_string(value), sqlFieldDataType<M>());
+                } else {
+                    attributes.emplace_back(field.name, value, sqlFieldDataType<M>());
+                }
+            });
+            return attributes;
+        }
 
+        //! \copydoc DosboxStagingReplacer::SqlDataResult::visitAttributes
+        void visitAttributes(SqlAttributeVisitor &visitor) const override {
+            forEachSqlField<T>([&]<typename M>(const SqlField<T, M> &field) {
+                const M &value = static_cast<const T &>(*this).*field.member;
+                if constexpr (std::is_same_v<M, bool>) {
+                    visitor.visit(field.name, value);
+                } else if constexpr (std::is_integral_v<M>) {
+                    visitor.visit(field.name, static_cast<int64_t>(value));
+                } else {
+                    visitor.visit(field.name, std::string_view(value));
+                }
+            });
+        }
+    };
+
+    /**
+     * @brief SqliteLastRowId class. Contains the information about the last row id.
+     */
+    class SqliteLastRowId final : public SqlDataResultModel<SqliteLastRowId> {
     public:
         int id;
 
         /**
-         * @brief Fills the SqliteLastRowId object with data from the statement.
-         * @param stmt Statement to fill the object with.
-         * @param parameters Parameters to use.
-         * @param engine SQL engine.
-         * @return std::any
-         */
-        std::any fillFromStatement(std::any stmt, std::vector<std::string> parameters, SqlEngine engine) override;
-
-        /**
-         * Returns all attributes of the object.
-         *
-         * @return Vector of (attribute name, value, data type).
+         * @brief Returns the column descriptors of the SqliteLastRowId object.
+         * @return Tuple of SqlField descriptors.
          */
-        [[nodiscard]] std::vector<std::tuple<std::string, std::string, DataResultDataType>>
-        getAttributes() const override {
-            return {{"id", std::to_string(id), DataResultDataType::Number}};
+        static constexpr auto fields() {
+            return std::tuple{SqlField{"id", &SqliteLastRowId::id, "last_insert_rowid()"}};
         }
     };
 
     /**
      * @brief SqliteSchema class. Contains the information about a SQLite schema.
      */
-    class SqliteSchema final : public SqlDataResult {
-        using SqlDataResult::SqlDataResult;
-
+    class SqliteSchema final : public SqlDataResultModel<SqliteSchema> {
     public:
         std::string type;
         std::string name;
@@ -98,33 +150,20 @@ namespace DosboxStagingReplacer {
         int rootpage;
 
         /**
-         * @brief Fills the SqliteSchema object with data from the statement.
-         * @param stmt Statement to fill the object with.
-         * @param parameters Parameters to use.
-         * @param engine SQL engine.
-         * @return std::any
-         */
-        std::any fillFromStatement(std::any stmt, std::vector<std::string> parameters, SqlEngine engine) override;
-
-        /**
-         * @brief Returns all attributes of the object.
-         * @return Vector of (attribute name, value, data type).
+         * @brief Returns the column descriptors of the SqliteSchema object.
+         * @return Tuple of SqlField descriptors.
          */
-        [[nodiscard]] std::vector<std::tuple<std::string, std::string, DataResultDataType>>
-        getAttributes() const override {
-            return {{"type", type, DataResultDataType::String},
-                    {"name", name, DataResultDataType::String},
-                    {"tbl_name", tbl_name, DataResultDataType::String},
-                    {"rootpage", std::to_string(rootpage), DataResultDataType::Number}};
+        static constexpr auto fields() {
+            return std::tuple{SqlField{"type", &SqliteSchema::type}, SqlField{"name", &SqliteSchema::name},
+                              SqlField{"tbl_name", &SqliteSchema::tbl_name},
+                              SqlField{"rootpage", &SqliteSchema::rootpage}};
         }
     };
 
     /**
      * @brief ProductDetails class. Contains the information about a GOG product.
      */
-    class ProductDetails final : public SqlDataResult {
-        using SqlDataResult::SqlDataResult;
-
+    class ProductDetails final : public SqlDataResultModel<ProductDetails> {
     public:
         int productId;
         std::string title;
@@ -135,65 +174,38 @@ namespace DosboxStagingReplacer {
         std::string installationDate;
 
         /**
-         * @brief Fills the ProductDetails object with data from the statement.
-         * @param stmt Statement to fill the object with.
-         * @param parameters Parameters to use.
-         * @param engine SQL engine.
-         * @return std::any
+         * @brief Returns the column descriptors of the ProductDetails object.
+         * @return Tuple of SqlField descriptors.
          */
-        std::any fillFromStatement(std::any stmt, std::vector<std::string> parameters, SqlEngine engine) override;
-
-        /**
-         * @brief Returns all attributes of the object.
-         * @return Vector of (attribute name, value, data type).
-         */
-        [[nodiscard]] std::vector<std::tuple<std::string, std::string, DataResultDataType>>
-        getAttributes() const override {
-            return {{"productId", std::to_string(productId), DataResultDataType::Number},
-                    {"title", title, DataResultDataType::String},
-                    {"slug", slug, DataResultDataType::String},
-                    {"gogId", std::to_string(gogId), DataResultDataType::Number},
-                    {"releaseKey", releaseKey, DataResultDataType::String},
-                    {"installationPath", installationPath, DataResultDataType::String},
-                    {"installationDate", installationDate, DataResultDataType::String}};
+        static constexpr auto fields() {
+            return std::tuple{SqlField{"productId", &ProductDetails::productId},
+                              SqlField{"title", &ProductDetails::title},
+                              SqlField{"slug", &ProductDetails::slug},
+                              SqlField{"gogId", &ProductDetails::gogId},
+                              SqlField{"releaseKey", &ProductDetails::releaseKey},
+                              SqlField{"installationPath", &ProductDetails::installationPath},
+                              SqlField{"installationDate", &ProductDetails::installationDate}};
         }
     };
 
     /**
      * @brief GogUser class. Contains the information about a GOG user.
      */
-    class GogUser final : public SqlDataResult {
-        using SqlDataResult::SqlDataResult;
-
+    class GogUser final : public SqlDataResultModel<GogUser> {
     public:
         int64_t id;
 
         /**
-         * @brief Fills the GogUser object with data from the statement.
-         * @param stmt Statement to fill the object with.
-         * @param parameters Parameters to use.
-         * @param engine SQL engine.
-         * @return std::any
-         */
-        std::any fillFromStatement(std::any stmt, std::vector<std::string> parameters, SqlEngine engine) override;
-
-        /**
-         * Returns all attributes of the object.
-         *
-         * @return Vector of (attribute name, value, data type).
+         * @brief Returns the column descriptors of the GogUser object.
+         * @return Tuple of SqlField descriptors.
          */
-        [[nodiscard]] std::vector<std::tuple<std::string, std::string, DataResultDataType>>
-        getAttributes() const override {
-            return {{"id", std::to_string(id), DataResultDataType::Number}};
-        }
+        static constexpr auto fields() { return std::tuple{SqlField{"id", &GogUser::id}}; }
     };
 
     /**
      * @brief PlayTaskInformation class. Contains the information about a play task.
      */
-    class PlayTaskInformation final : public SqlDataResult {
-        using SqlDataResult::SqlDataResult;
-
+    class PlayTaskInformation final : public SqlDataResultModel<PlayTaskInformation> {
     public:
         int id;
         std::string gameReleaseKey;
@@ -204,36 +216,52 @@ namespace DosboxStagingReplacer {
         bool isPrimary;
 
         /**
-         * @brief Fills the PlayTaskInformation object with data from the statement.
-         * @param stmt Statement to fill the object with.
-         * @param parameters Parameters to use.
-         * @param engine SQL engine.
-         * @return std::any
+         * @brief Returns the column descriptors of the PlayTaskInformation object.
+         * @return Tuple of SqlField descriptors.
          */
-        std::any fillFromStatement(std::any stmt, std::vector<std::string> parameters, SqlEngine engine) override;
+        static constexpr auto fields() {
+            return std::tuple{SqlField{"id", &PlayTaskInformation::id},
+                              SqlField{"gameReleaseKey", &PlayTaskInformation::gameReleaseKey},
+                              SqlField{"userId", &PlayTaskInformation::userId},
+                              SqlField{"order", &PlayTaskInformation::order},
+                              SqlField{"typeId", &PlayTaskInformation::typeId},
+                              SqlField{"type", &PlayTaskInformation::type},
+                              SqlField{"isPrimary", &PlayTaskInformation::isPrimary}};
+        }
+    };
+
+    /**
+     * @brief Read-only PlayTaskInformation whose text columns are views into the result set that returned them.
+     */
+    class PlayTaskInformationView final : public SqlDataResultModel<PlayTaskInformationView> {
+    public:
+        int id;
+        std::string_view gameReleaseKey;
+        int userId;
+        int order;
+        int typeId;
+        std::string_view type;
+        bool isPrimary;
 
         /**
-         * @brief Returns all attributes of the object.
-         * @return Vector of (attribute name, value, data type).
+         * @brief Returns the column descriptors of the PlayTaskInformationView object.
+         * @return Tuple of SqlField descriptors.
          */
-        [[nodiscard]] std::vector<std::tuple<std::string, std::string, DataResultDataType>>
-        getAttributes() const override {
-            return {{"id", std::to_string(id), DataResultDataType::Number},
-                    {"gameReleaseKey", gameReleaseKey, DataResultDataType::String},
-                    {"userId", std::to_string(userId), DataResultDataType::Number},
-                    {"order", std::to_string(order), DataResultDataType::Number},
-                    {"typeId", std::to_string(typeId), DataResultDataType::Number},
-                    {"type", type, DataResultDataType::String},
-                    {"isPrimary", isPrimary ? "true" : "false", DataResultDataType::Boolean}};
+        static constexpr auto fields() {
+            return std::tuple{SqlField{"id", &PlayTaskInformationView::id},
+                              SqlField{"gameReleaseKey", &PlayTaskInformationView::gameReleaseKey},
+                              SqlField{"userId", &PlayTaskInformationView::userId},
+                              SqlField{"order", &PlayTaskInformationView::order},
+                              SqlField{"typeId", &PlayTaskInformationView::typeId},
+                              SqlField{"type", &PlayTaskInformationView::type},
+                              SqlField{"isPrimary", &PlayTaskInformationView::isPrimary}};
         }
     };
 
     /**
      * @brief PlayTaskLaunchParameters class. Contains the information about a play task launch parameters.
      */
-    class PlayTaskLaunchParameters final : public SqlDataResult {
-        using SqlDataResult::SqlDataResult;
-
+    class PlayTaskLaunchParameters final : public SqlDataResultModel<PlayTaskLaunchParameters> {
     public:
         int playTaskId;
         std::string executablePath;
@@ -241,178 +269,59 @@ namespace DosboxStagingReplacer {
         std::string label;
 
         /**
-         * @brief Fills the PlayTaskLaunchParameters object with data from the statement.
-         * @param stmt Statement to fill the object with.
-         * @param parameters Parameters to use.
-         * @param engine SQL engine.
-         * @return std::any
-         */
-        std::any fillFromStatement(std::any stmt, std::vector<std::string> parameters, SqlEngine engine) override;
-
-        /**
-         * @brief Returns all attributes of the object.
-         * @return Vector of (attribute name, value, data type).
+         * @brief Returns the column descriptors of the PlayTaskLaunchParameters object.
+         * @return Tuple of SqlField descriptors.
          */
-        [[nodiscard]] std::vector<std::tuple<std::string, std::string, DataResultDataType>>
-        getAttributes() const override {
-            return {{"playTaskId", std::to_string(playTaskId), DataResultDataType::Number},
-                    {"executablePath", executablePath, DataResultDataType::String},
-                    {"commandLineArgs", commandLineArgs, DataResultDataType::String},
-                    {"label", label, DataResultDataType::String}};
+        static constexpr auto fields() {
+            return std::tuple{SqlField{"playTaskId", &PlayTaskLaunchParameters::playTaskId},
+                              SqlField{"executablePath", &PlayTaskLaunchParameters::executablePath},
+                              SqlField{"commandLineArgs", &PlayTaskLaunchParameters::commandLineArgs},
+                              SqlField{"label", &PlayTaskLaunchParameters::label}};
         }
     };
 
-    class PlayTaskType final : public SqlDataResult {
-        using SqlDataResult::SqlDataResult;
-
+    /**
+     * @brief PlayTaskType class. Contains the information about a play task type.
+     */
+    class PlayTaskType final : public SqlDataResultModel<PlayTaskType> {
     public:
         int id;
         std::string type;
 
         /**
-         * @brief Fills the PlayTaskLaunchParameters object with data from the statement.
-         * @param stmt Statement to fill the object with.
-         * @param parameters Parameters to use.
-         * @param engine SQL engine.
-         * @return std::any
+         * @brief Returns the column descriptors of the PlayTaskType object.
+         * @return Tuple of SqlField descriptors.
          */
-        std::any fillFromStatement(std::any stmt, std::vector<std::string> parameters, SqlEngine engine) override;
-
-        /**
-         * @brief Returns all attributes of the object.
-         * @return Vector of (attribute name, value, data type).
-         */
-        [[nodiscard]] std::vector<std::tuple<std::string, std::string, DataResultDataType>>
-        getAttributes() const override {
-            return {{"id", std::to_string(id), DataResultDataType::Number}, {"type", type, DataResultDataType::String}};
+        static constexpr auto fields() {
+            return std::tuple{SqlField{"id", &PlayTaskType::id}, SqlField{"type", &PlayTaskType::type}};
         }
     };
 
     /**
-     * @brief Base class for parsing SQL statements.
+     * @brief DosClassification class. Contains the cached result of scanning a game installation for DOSBox.
      */
-    class StatementParser {
+    class DosClassification final : public SqlDataResultModel<DosClassification> {
     public:
-        StatementParser();
-        virtual ~StatementParser();
-
-        /**
-         * @brief Parses a SQL result into a SqlDataResult object.
-         * @param result The SqlDataResult object to fill.
-         * @param parameters The parameters to use.
-         * @param stmt The statement to parse.
-         */
-        virtual void parseInto(SqlDataResult &result, std::vector<std::string> parameters, std::any stmt) = 0;
-
-        /**
-         * @brief Parses a SQL result into a SqliteLastRowId object.
-         * @param result The SqliteLastRowId object to fill.
-         * @param parameters The parameters to use.
-         * @param stmt The statement to parse.
-         */
-        virtual void parseInto(SqliteLastRowId &result, std::vector<std::string> parameters, std::any stmt) = 0;
-        /**
-         * @brief Parses a SQL result into a SqliteSchema object.
-         * @param result The SqliteSchema object to fill.
-         * @param parameters The parameters to use.
-         * @param stmt The statement to parse.
-         */
-        virtual void parseInto(SqliteSchema &result, std::vector<std::string> parameters, std::any stmt) = 0;
-        /**
-         * @brief Parses a SQL result into a ProductDetails object.
-         * @param result The ProductDetails object to fill.
-         * @param parameters The parameters to use.
-         * @param stmt The statement to parse.
-         */
-        virtual void parseInto(ProductDetails &result, std::vector<std::string> parameters, std::any stmt) = 0;
-        /**
-         * @brief Parses a SQL result into a GogUser object.
-         * @param result The GogUser object to fill.
-         * @param parameters The parameters to use.
-         * @param stmt The statement to parse.
-         */
-        virtual void parseInto(GogUser &result, std::vector<std::string> parameters, std::any stmt) = 0;
-        /**
-         * @brief Parses a SQL result into a PlayTaskInformation object.
-         * @param result The PlayTaskInformation object to fill.
-         * @param parameters The parameters to use.
-         * @param stmt The statement to parse.
-         */
-        virtual void parseInto(PlayTaskInformation &result, std::vector<std::string> parameters, std::any stmt) = 0;
-        /**
-         * @brief Parses a SQL result into a PlayTaskLaunchParameters object.
-         * @param result The PlayTaskLaunchParameters object to fill.
-         * @param parameters The parameters to use.
-         * @param stmt The statement to parse.
-         */
-        virtual void parseInto(PlayTaskLaunchParameters &result, std::vector<std::string> parameters,
-                               std::any stmt) = 0;
-        /**
-         * @brief Parses a SQL result into a PlayTaskLaunchParameters object.
-         * @param result The PlayTaskType object to fill.
-         * @param parameters The parameters to use.
-         * @param stmt The statement to parse.
-         */
-        virtual void parseInto(PlayTaskType &result, std::vector<std::string> parameters, std::any stmt) = 0;
-    };
-
-    class SqliteStatementParser final : public StatementParser {
-    public:
-        SqliteStatementParser();
-        ~SqliteStatementParser() override;
-
-        //! \copydoc DosboxStagingReplacer::StatementParser::parseInto(DosboxStagingReplacer::SqlDataResult&,
-        //! std::vector<std::string>, std::any)
-        void parseInto(SqlDataResult &result, std::vector<std::string> parameters, std::any stmtAny) override;
-        //! \copydoc DosboxStagingReplacer::StatementParser::parseInto(DosboxStagingReplacer::SqliteLastRowId&,
-        //! std::vector<std::string>, std::any)
-        void parseInto(SqliteLastRowId &result, std::vector<std::string> parameters, std::any stmtAny) override;
-        //! \copydoc DosboxStagingReplacer::StatementParser::parseInto(DosboxStagingReplacer::SqliteSchema&,
-        //! std::vector<std::string>, std::any)
-        void parseInto(SqliteSchema &result, std::vector<std::string> parameters, std::any stmtAny) override;
-        //! \copydoc DosboxStagingReplacer::StatementParser::parseInto(DosboxStagingReplacer::ProductDetails&,
-        //! std::vector<std::string>, std::any)
-        void parseInto(ProductDetails &result, std::vector<std::string> parameters, std::any stmtAny) override;
-        //! \copydoc DosboxStagingReplacer::StatementParser::parseInto(DosboxStagingReplacer::GogUser&,
-        //! std::vector<std::string>, std::any)
-        void parseInto(GogUser &result, std::vector<std::string> parameters, std::any stmtAny) override;
-        //! \copydoc DosboxStagingReplacer::StatementParser::parseInto(DosboxStagingReplacer::PlayTaskInformation&,
-        //! std::vector<std::string>, std::any)
-        void parseInto(PlayTaskInformation &result, std::vector<std::string> parameters, std::any stmtAny) override;
-        //! \copydoc DosboxStagingReplacer::StatementParser::parseInto(DosboxStagingReplacer::PlayTaskLaunchParameters&,
-        //! std::vector<std::string>, std::any)
-        void parseInto(PlayTaskLaunchParameters &result, std::vector<std::string> parameters,
-                       std::any stmtAny) override;
-        //! \copydoc DosboxStagingReplacer::StatementParser::parseInto(DosboxStagingReplacer::PlayTaskType&,
-        //! std::vector<std::string>, std::any)
-        void parseInto(PlayTaskType &result, std::vector<std::string> parameters, std::any stmtAny) override;
-    };
+        std::string installationPath;
+        int64_t modifiedTime = 0;
+        int64_t inode = 0;
+        bool isDos = false;
+        std::string dosboxPath;
+        /// Paths of the .conf files found in the installation directory, separated by newlines
+        std::string configFiles;
 
-    /**
-     * @brief Factory class for creating StatementParser objects.
-     */
-    class StatementParserFactory {
-    public:
         /**
-         * Creates a StatementParser object based on the SqlEngine.
-         *
-         * @param engine SQL engine type.
-         * @return A unique_ptr to a StatementParser.
+         * @brief Returns the column descriptors of the DosClassification object.
+         * @return Tuple of SqlField descriptors.
          */
-        static std::unique_ptr<StatementParser> createParser(SqlEngine engine);
-    };
-
-    class StatementEngineParserFactoryException final : public std::exception {
-    public:
-        explicit StatementEngineParserFactoryException(const char *message) : msg(message) {}
-        StatementEngineParserFactoryException(StatementEngineParserFactoryException const &) noexcept = default;
-        StatementEngineParserFactoryException &
-        operator=(StatementEngineParserFactoryException const &) noexcept = default;
-        ~StatementEngineParserFactoryException() override = default;
-        [[nodiscard]] const char *what() const noexcept override { return msg; }
-
-    private:
-        const char *msg;
+        static constexpr auto fields() {
+            return std::tuple{SqlField{"installationPath", &DosClassification::installationPath},
+                              SqlField{"modifiedTime", &DosClassification::modifiedTime},
+                              SqlField{"inode", &DosClassification::inode},
+                              SqlField{"isDos", &DosClassification::isDos},
+                              SqlField{"dosboxPath", &DosClassification::dosboxPath},
+                              SqlField{"configFiles", &DosClassification::configFiles}};
+        }
     };
 
 } // namespace DosboxStagingReplacer
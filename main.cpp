@@ -1,5 +1,7 @@
 #include <filesystem>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
 
 #ifdef _WIN32
@@ -11,7 +13,9 @@
 #include "GogGalaxyService.h"
 #include "ScriptEditService.h"
 #include "StatementParser.h"
+#include "helpers/finders/ApplicationInventory.h"
 #include "helpers/finders/InstallationFinder.h"
+#include "helpers/finders/KeywordMatcher.h"
 #include "helpers/scanners/DirectoryScanner.h"
 #include "helpers/verifiers/InstallationVerifier.h"
 
@@ -64,6 +68,12 @@ int main(int argc, char *argv[]) {
             .default_value(false)
             .implicit_value(true)
             .nargs(0);
+    program.add_argument("-j", "--jobs")
+            .help("The number of game directories scanned at the same time when using --dos-only. "
+                  "0 uses one per hardware thread.")
+            .default_value(0u)
+            .scan<'u', unsigned int>()
+            .nargs(1);
     program.add_argument("-lg", "--list-games")
             .help("Print all installed games")
             .default_value(false)
@@ -116,7 +126,8 @@ int main(int argc, char *argv[]) {
             .choices(".json", ".csv", ".txt")
             .nargs(1);
     program.add_argument("-o", "--output")
-            .help("The name of the output file. If \"\", the output will be printed to the console.")
+            .help("The name of the output file. If \"\", the output will be printed to the console. "
+                  "The file is only replaced once the whole output was written.")
             .default_value(std::string(""))
             .nargs(1);
 
@@ -216,15 +227,36 @@ int main(int argc, char *argv[]) {
         // Initialize a data exporter base on the format chosen by the user
         const auto dataExporter =
                 DosboxStagingReplacer::DataExporterFactory::createDataExporter(program.get<std::string>("--format"));
+        // Every list command writes through this, to the --output file when it is set, otherwise to the console
+        // A file only appears once the export succeeded, an interrupted export leaves no partial file behind
+        const auto outputPath = program.get<std::string>("--output");
+        const auto exportOutput = [&](const std::function<void(DosboxStagingReplacer::OutputSink &)> &write) {
+            try {
+                std::unique_ptr<DosboxStagingReplacer::OutputSink> output;
+                if (outputPath.empty())
+                    output = std::make_unique<DosboxStagingReplacer::StdoutSink>();
+                else
+                    output = std::make_unique<DosboxStagingReplacer::AtomicFileSink>(outputPath);
+                write(*output);
+                output->finish();
+                return true;
+            } catch (const std::exception &e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return false;
+            }
+        };
         // We initialize a vector of FileEntity objects to store the files and use it later with DirectoryScanner
         // Then keep it so we can pass it to the file backup service, this skips the FileBackupService from re-scanning
         // the directory
         std::vector<DosboxStagingReplacer::FileEntity> files;
         // The service class for the GoG Galaxy database
         DosboxStagingReplacer::GogGalaxyService service;
+        service.setScanJobs(program.get<unsigned int>("--jobs"));
 
         try {
-            files = DosboxStagingReplacer::DirectoryScanner::scanDirectory(chosenPath.string());
+            // Backup, restore and --list-backups only ever look at the database and its backups
+            files = DosboxStagingReplacer::DirectoryScanner::scanDirectory(chosenPath.string(),
+                                                                           {.namePrefixes = {chosenFile.string()}});
         } catch (const std::exception &e) {
             std::cerr << "Error: " << e.what() << std::endl;
             return -1;
@@ -249,70 +281,84 @@ int main(int argc, char *argv[]) {
             service.closeConnection();
             auto restoredFile = fileBackupService.restoreFromBackup((chosenPath / chosenFile).string(), files);
         } else if (program["--list-backups"] == true) {
+            // We iterate to the files variable we already made and filter out the GogGalaxy database itself
+            const auto backupPrefix = chosenFile.string() + fileBackupService.getBackupFileExtension();
             std::vector<DosboxStagingReplacer::FileEntity> filteredFiles;
-            // We iterate to the files variable we already made and filter out non GogGalaxy database files
             std::ranges::copy_if(files, std::back_inserter(filteredFiles), [&](const auto &file) {
-                return file.path.find(chosenFile.string() + fileBackupService.getBackupFileExtension()) !=
-                       std::string::npos;
+                return file.name.starts_with(backupPrefix);
             });
-            std::cout << dataExporter->serialize(filteredFiles) << std::endl;
+            if (!exportOutput([&](DosboxStagingReplacer::OutputSink &output) {
+                    dataExporter->write(output, filteredFiles);
+                    output.put('\n');
+                }))
+                return -1;
         } else if (program["--list-applications"] == true) {
             std::vector<DosboxStagingReplacer::InstallationInfo> applications;
             if (program["--dos-only"] == true)
                 applications = DosboxStagingReplacer::InstallationFinder::findApplication("DOSBox");
             else
-                applications = DosboxStagingReplacer::getInstalledApplications();
+                applications = *DosboxStagingReplacer::ApplicationInventory::system().getApplications();
             // Filter the applications based on the search string if it is not empty
             if (!searchString.empty()) {
+                // Every word of the search string must be in the name, the search string is lowercased only once
+                const DosboxStagingReplacer::KeywordMatcher matcher(searchString);
                 std::vector<DosboxStagingReplacer::InstallationInfo> filteredApplications;
-                std::ranges::copy_if(applications, std::back_inserter(filteredApplications), [&](const auto &app) {
-                    std::string lowerCaseName = app.applicationName;
-                    std::ranges::transform(lowerCaseName, lowerCaseName.begin(), tolower);
-                    std::string lowerCaseSearchString = searchString;
-                    std::ranges::transform(lowerCaseSearchString, lowerCaseSearchString.begin(), tolower);
-                    return lowerCaseName.find(lowerCaseSearchString) != std::string::npos;
-                });
+                std::ranges::copy_if(applications, std::back_inserter(filteredApplications),
+                                     [&](const auto &app) { return matcher.matches(app.applicationName); });
                 applications = filteredApplications;
             }
-            std::cout << dataExporter->serialize(applications) << std::endl;
+            if (!exportOutput([&](DosboxStagingReplacer::OutputSink &output) {
+                    dataExporter->write(output, applications);
+                    output.put('\n');
+                }))
+                return -1;
         } else if (program["--list-games"] == true) {
-            // Need to convert the result of getProducts to a vector of shared pointers so we can
-            // take advantage of polymorphism
-            std::vector<std::shared_ptr<DosboxStagingReplacer::SqlDataResult>> games;
-            service.openConnection((chosenPath / chosenFile).string());
-            for (auto &product: service.getProducts({}, program.get<bool>("--dos-only"))) {
-                games.push_back(std::make_shared<DosboxStagingReplacer::ProductDetails>(product));
+            // Rows are exported as they are read so no list of games is ever held in memory
+            std::string lowerCaseSearchString = searchString;
+            std::ranges::transform(lowerCaseSearchString, lowerCaseSearchString.begin(), tolower);
+            std::string lowerCaseTitle;
+            size_t index = 0;
+            if (const auto cacheDirectory = DosboxStagingReplacer::ApplicationInventory::getCacheDirectory();
+                program.get<bool>("--dos-only") && !cacheDirectory.empty()) {
+                // Under the user cache directory, the GOG Galaxy storage directory belongs to GOG Galaxy
+                service.setDosClassificationCache(
+                        (std::filesystem::path(cacheDirectory) / "dos-classifications.sqlite").string());
             }
-            // Filter the applications based on the search string if it is not empty
-            if (!searchString.empty()) {
-                std::vector<std::shared_ptr<DosboxStagingReplacer::SqlDataResult>> filteredGames;
-                std::ranges::copy_if(games, std::back_inserter(filteredGames),
-                                     [&](const std::shared_ptr<DosboxStagingReplacer::SqlDataResult> &game) {
-                                         // We need to cast the SqlDataResult to ProductDetails to access the title
-                                         if (game) {
-                                             const auto *gameDetails =
-                                                 dynamic_cast<DosboxStagingReplacer::ProductDetails *>(game.get());
-                                             std::string lowerCaseTitle = gameDetails->title;
-                                             std::ranges::transform(lowerCaseTitle, lowerCaseTitle.begin(), tolower);
-                                             std::string lowerCaseSearchString = searchString;
-                                             std::ranges::transform(lowerCaseSearchString, lowerCaseSearchString.begin(),
-                                                                    tolower);
-                                             return lowerCaseTitle.find(lowerCaseSearchString) != std::string::npos;
-                                         }
-                                         return false;
-                                     });
-                games = filteredGames;
-            }
-            std::cout << dataExporter->serialize(games) << std::endl;
+            service.openConnection((chosenPath / chosenFile).string());
+            const bool exported = exportOutput([&](DosboxStagingReplacer::OutputSink &output) {
+                dataExporter->writeHeader(output);
+                service.forEachProduct({}, program.get<bool>("--dos-only"),
+                                       [&](const DosboxStagingReplacer::ProductDetails &product) {
+                                           // Filter the games based on the search string if it is not empty
+                                           if (!lowerCaseSearchString.empty()) {
+                                               lowerCaseTitle = product.title;
+                                               std::ranges::transform(lowerCaseTitle, lowerCaseTitle.begin(),
+                                                                      tolower);
+                                               if (lowerCaseTitle.find(lowerCaseSearchString) == std::string::npos) {
+                                                   return;
+                                               }
+                                           }
+                                           dataExporter->writeRow(output, product, index++);
+                                       });
+                dataExporter->writeFooter(output);
+                output.put('\n');
+            });
             service.closeConnection();
+            if (!exported)
+                return -1;
         } else if (program["--show-playtasks"] == true) {
-            std::vector<std::shared_ptr<DosboxStagingReplacer::SqlDataResult>> playTasks;
             service.openConnection((chosenPath / chosenFile).string());
-            for (auto &playTask: service.getPlayTasksFromGameReleaseKey(releaseKey)) {
-                playTasks.push_back(std::make_shared<DosboxStagingReplacer::PlayTaskInformation>(playTask));
-            }
-            std::cout << dataExporter->serialize(playTasks) << std::endl;
+            const auto playTasks = service.getPlayTaskViewsFromGameReleaseKey(releaseKey);
             service.closeConnection();
+            if (!exportOutput([&](DosboxStagingReplacer::OutputSink &output) {
+                    dataExporter->writeHeader(output);
+                    for (size_t i = 0; i < playTasks.size(); ++i) {
+                        dataExporter->writeRow(output, playTasks[i], i);
+                    }
+                    dataExporter->writeFooter(output);
+                    output.put('\n');
+                }))
+                return -1;
         } else if (program["--replace-dosbox"] == true) {
             const auto dosboxArgument = program.get<std::string>("--dosbox-version");
             const auto dosboxManualPath = program.get<std::string>("--dosbox-version-manual");
@@ -323,29 +369,20 @@ int main(int argc, char *argv[]) {
                         dosBoxVersionParameters[dosboxArgument]);
                 // No need to do checking here and should not be done because we already did that at the earlier parts
                 // of the code Scan the files in the application installation path
-                std::cout << "Scanning chosen dosbox directory" << std::endl;
-                auto dosBoxFiles =
-                        DosboxStagingReplacer::DirectoryScanner::scanDirectory(application.front().installationPath);
-                // If somehow there are no files under that folder, we return an error
-                if (dosBoxFiles.empty()) {
-                    std::cerr << "Error: There are no files in the application installation path" << std::endl;
-                }
-
                 std::cout << "Searching for dosbox.exe in the application installation path" << std::endl;
 
                 // We search if there is dosbox.exe in the directory, we search in non-case sensitive search
-                auto dosBoxExeSearch = std::ranges::find_if(dosBoxFiles, [&](const auto &file) {
-                    std::string lowerCaseName = file.name;
-                    std::ranges::transform(lowerCaseName, lowerCaseName.begin(), tolower);
-                    return lowerCaseName == "dosbox.exe";
-                });
+                // Only that entry is ever read into a FileEntity
+                auto dosBoxFiles = DosboxStagingReplacer::DirectoryScanner::scanDirectory(
+                        application.front().installationPath, {.nameGlobs = {"dosbox.exe"},
+                                                               .globsIgnoreCase = true,
+                                                               .type = DosboxStagingReplacer::FileType::FILE});
                 // We search if there is dosbox.exe, if there is none, then we return an error
-                if (dosBoxExeSearch == dosBoxFiles.end()) {
+                if (dosBoxFiles.empty()) {
                     std::cerr << "Error: There is no dosbox.exe in the application installation path" << std::endl;
                     return -1;
                 }
-                // Assign dosBoxExeSearch to dosBoxExe
-                dosBoxExe = std::make_shared<DosboxStagingReplacer::FileEntity>(*dosBoxExeSearch);
+                dosBoxExe = std::make_shared<DosboxStagingReplacer::FileEntity>(std::move(dosBoxFiles.front()));
                 std::cout << "Successfully found dosbox.exe in the application installation path" << std::endl;
             } else if (!dosboxManualPath.empty()) {
                 std::filesystem::path manualPath = dosboxManualPath;
@@ -416,20 +453,34 @@ int main(int argc, char *argv[]) {
             // the vector
 
             // Now we do the real work, add play task here on Gog database
+            // Everything is done in a single batch so either all users get patched or the database is left as is
+            try {
+                service.executeBatch([&] {
+                    if (program.get<bool>("--all-users") == true) {
+                        for (const auto &user: users) {
+                            service.addPlayTask(user.id, releaseKey, playTaskForInsertion,
+                                                launchParametersForInsertion);
+                        }
+                    } else {
+                        const auto &user = users.back();
+                        service.addPlayTask(user.id, releaseKey, playTaskForInsertion, launchParametersForInsertion);
+                    }
+
+                    // Afterward we set the custom launch parameters to enable for this
+                    service.setCustomLaunchParametersForProduct(releaseKey, true);
+                });
+            } catch (const std::exception &e) {
+                std::cerr << "Error: Failed to modify the Gog database, no changes were made: " << e.what()
+                          << std::endl;
+                return -1;
+            }
+
             if (program.get<bool>("--all-users") == true) {
-                for (const auto& user: users) {
-                    service.addPlayTask(user.id, releaseKey, playTaskForInsertion, launchParametersForInsertion);
-                }
                 std::cout << "Successfully added play task for all users" << std::endl;
             } else {
-                const auto& user = users.back();
-                service.addPlayTask(user.id, releaseKey, playTaskForInsertion, launchParametersForInsertion);
                 std::cout << "Successfully added play task for most recent user" << std::endl;
             }
 
-            // Afterward we set the custom launch parameters to enable for this
-            service.setCustomLaunchParametersForProduct(releaseKey, true);
-
             std::cout << "Modifications completed" << std::endl;
 
             // We are now done with adjusting anything on Gog!
@@ -438,7 +489,9 @@ int main(int argc, char *argv[]) {
             std::cout << "Modifying Dosbox configuration files for product" << std::endl;
 
             // We finally adjust the files using ScriptEditService
-            auto productFiles = DosboxStagingReplacer::DirectoryScanner::scanDirectory(product.installationPath);
+            // DOSBox configurations are .conf files, only those are opened to look at their sections
+            auto productFiles = DosboxStagingReplacer::DirectoryScanner::scanDirectory(
+                    product.installationPath, {.suffixes = {".conf"}, .type = DosboxStagingReplacer::FileType::FILE});
             // Find the config files, all of these files contain [autoexec] in their file
 
             std::vector<DosboxStagingReplacer::FileEntity> configAutoExecFiles;
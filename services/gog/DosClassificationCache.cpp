@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <filesystem>
+#include <sys/stat.h>
+
+#include "DosClassificationCache.h"
+
+namespace DosboxStagingReplacer {
+
+    DosClassificationCache::DosClassificationCache(const std::string &cachePath) {
+        // The cache directory may not exist yet on the first run
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+        this->sqlService.createConnection(cachePath);
+        this->sqlService.executeQuery(R"SQL(
+            CREATE TABLE IF NOT EXISTS DosClassifications (
+                installationPath TEXT PRIMARY KEY,
+                modifiedTime     INT64 NOT NULL,
+                inode            INT64 NOT NULL,
+                isDos            BOOLEAN NOT NULL,
+                dosboxPath       TEXT,
+                configFiles      TEXT
+            );
+        )SQL", {});
+
+        for (auto &classification: this->sqlService.executeQuery<DosClassification>(R"SQL(
+                SELECT installationPath, modifiedTime, inode, isDos, dosboxPath, configFiles
+                FROM DosClassifications;
+            )SQL", {})) {
+            auto installationPath = classification.installationPath;
+            this->entries.emplace(std::move(installationPath), std::move(classification));
+        }
+    }
+
+    const DosClassification *DosClassificationCache::find(const DosClassification &current) const {
+        const auto entry = this->entries.find(current.installationPath);
+        if (entry == this->entries.end() || entry->second.modifiedTime != current.modifiedTime ||
+            entry->second.inode != current.inode) {
+            return nullptr;
+        }
+        return &entry->second;
+    }
+
+    void DosClassificationCache::store(const std::vector<DosClassification> &classifications) {
+        if (classifications.empty()) {
+            return;
+        }
+
+        this->sqlService.beginTransaction();
+        try {
+            for (const auto &classification: classifications) {
+                this->sqlService.executeQueryFromModel(R"SQL(
+                    INSERT OR REPLACE INTO DosClassifications
+                        (installationPath, modifiedTime, inode, isDos, dosboxPath, configFiles)
+                    VALUES
+                        (:installationPath, :modifiedTime, :inode, :isDos, :dosboxPath, :configFiles);
+                )SQL", classification);
+                this->entries[classification.installationPath] = classification;
+            }
+            this->sqlService.commitTransaction();
+        } catch (...) {
+            this->sqlService.rollbackTransaction();
+            throw;
+        }
+    }
+
+    size_t DosClassificationCache::size() const {
+        return this->entries.size();
+    }
+
+    bool DosClassificationCache::readDirectoryStamp(DosClassification &classification) {
+        struct stat status {};
+        if (stat(classification.installationPath.c_str(), &status) != 0 || (status.st_mode & S_IFMT) != S_IFDIR) {
+            return false;
+        }
+
+        // Adding, removing or renaming an entry updates the directory modification time, which is all
+        // the classification depends on. Sub-second precision is used where the platform provides it
+#ifdef _WIN32
+        classification.modifiedTime = static_cast<int64_t>(status.st_mtime) * 1000000000;
+#elif defined(__APPLE__)
+        classification.modifiedTime =
+                static_cast<int64_t>(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+        classification.modifiedTime = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+        classification.inode = static_cast<int64_t>(status.st_ino);
+        return true;
+    }
+
+    void DosClassificationCache::classify(DosClassification &classification) {
+        // Same rule as the uncached check, an entry whose path contains DOSBOX marks a DOS game
+        const bool pathMatches = classification.installationPath.find("DOSBOX") != std::string::npos;
+        classification.dosboxPath.clear();
+        classification.configFiles.clear();
+
+        for (const auto &entry: std::filesystem::directory_iterator(classification.installationPath)) {
+            if (classification.dosboxPath.empty() &&
+                (pathMatches || entry.path().filename().string().find("DOSBOX") != std::string::npos)) {
+                classification.dosboxPath = entry.path().string();
+            }
+
+            auto extension = entry.path().extension().string();
+            std::ranges::transform(extension, extension.begin(), tolower);
+            if (extension == ".conf") {
+                if (!classification.configFiles.empty()) {
+                    classification.configFiles += '\n';
+                }
+                classification.configFiles += entry.path().string();
+            }
+        }
+        classification.isDos = !classification.dosboxPath.empty();
+    }
+
+} // namespace DosboxStagingReplacer
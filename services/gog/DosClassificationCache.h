@@ -0,0 +1,67 @@
+#ifndef DOSCLASSIFICATIONCACHE_H
+#define DOSCLASSIFICATIONCACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SqlService.h"
+#include "StatementParser.h"
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief Persistent cache of which game installations are DOS games.
+     *
+     * Classifications are stored in a small SQLite database of their own, never in the Galaxy database,
+     * and are keyed by installation path. An entry stays valid for as long as the modification time and
+     * inode of the installation directory are unchanged, so checking it costs a single stat instead of a
+     * directory walk.
+     */
+    class DosClassificationCache {
+        SqlLiteService sqlService;
+        std::unordered_map<std::string, DosClassification> entries;
+
+    public:
+        /**
+         * @brief Opens the cache, creating the cache database if it does not exist yet.
+         * All entries are loaded up front so lookups never touch the database.
+         * @param cachePath Path to the cache database file, it and its directory are created if missing.
+         */
+        explicit DosClassificationCache(const std::string &cachePath);
+
+        /**
+         * @brief Looks up an installation, the lookup itself is safe to run from several threads.
+         * @param current The installation path and directory stamp as read by readDirectoryStamp.
+         * @return The cached classification, or nullptr if there is none or the directory changed since.
+         */
+        [[nodiscard]] const DosClassification *find(const DosClassification &current) const;
+
+        /**
+         * @brief Adds or replaces classifications, all of them are written in a single transaction.
+         * @param classifications The classifications to store.
+         */
+        void store(const std::vector<DosClassification> &classifications);
+
+        /**
+         * @brief Returns the number of cached installations.
+         */
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * @brief Reads the modification time and inode of an installation directory.
+         * @param classification The classification to fill, its installationPath must be set.
+         * @return true if the directory could be read, false otherwise.
+         */
+        static bool readDirectoryStamp(DosClassification &classification);
+
+        /**
+         * @brief Scans an installation directory and fills in the DOSBox folder and the config files.
+         * Only the entry names are read, no file sizes or contents.
+         * @param classification The classification to fill, its installationPath must be set.
+         */
+        static void classify(DosClassification &classification);
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // DOSCLASSIFICATIONCACHE_H
@@ -3,6 +3,8 @@
 //
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "DirectoryScanner.h"
 #include "GogGalaxyService.h"
@@ -44,8 +46,8 @@ namespace DosboxStagingReplacer {
                 UPDATE PlayTasks
                 SET isPrimary = 0
                 WHERE gameReleaseKey = :gameReleaseKey;
-            ")SQL",
-                                          {{"gameReleaseKey", gameReleaseKey}});
+            )SQL",
+                                          {gameReleaseKey});
         } else {
             throw GogGalaxyServiceException("Database connection is not open");
         }
@@ -59,12 +61,9 @@ namespace DosboxStagingReplacer {
             this->sqlService.executeQuery(R"SQL(
                 INSERT INTO PlayTasks (gameReleaseKey, userId, "order", typeId, isPrimary)
                 VALUES (:gameReleaseKey, :userId, :new_order, :typeId, :isPrimary);
-            ")SQL",
-                                          {{"gameReleaseKey", playTask.gameReleaseKey},
-                                           {"userId", userId},
-                                           {"new_order", new_order},
-                                           {"typeId", playTask.typeId},
-                                           {"isPrimary", playTask.isPrimary}});
+            )SQL",
+                                          {playTask.gameReleaseKey, userId, new_order, playTask.typeId,
+                                           playTask.isPrimary});
 
             // Get the id of the new PlayTask
             const auto result = this->sqlService.executeQuery<SqliteLastRowId>(R"SQL(
@@ -93,10 +92,8 @@ namespace DosboxStagingReplacer {
                 INSERT INTO PlayTaskLaunchParameters (playTaskId, executablePath, commandLineArgs, label)
                 VALUES (:playTaskId, :executablePath, :commandLineArgs, :label);
             )SQL",
-                                          {{"playTaskId", playTask.id},
-                                           {"executablePath", launchParameters.executablePath},
-                                           {"commandLineArgs", launchParameters.commandLineArgs},
-                                           {"label", launchParameters.label}});
+                                          {playTask.id, launchParameters.executablePath,
+                                           launchParameters.commandLineArgs, launchParameters.label});
         } else {
             throw GogGalaxyServiceException("Database connection is not open");
         }
@@ -124,61 +121,146 @@ namespace DosboxStagingReplacer {
 
     bool GogGalaxyService::isDatabaseValid() const { return this->validDatabase; }
 
-    std::vector<ProductDetails> GogGalaxyService::getProducts(const std::optional<std::string> &releaseKey,
-                                                              const bool showDosOnly) {
-        if (this->validDatabase) {
-            std::string query = R"SQL(
-                SELECT
-                    pdv.productId,
-                    pdv.title,
-                    pdv.slug,
-                    ptr.gogId,
-                    ptr.releaseKey,
-                    ibp.installationPath,
-                    ibp.installationDate
-                FROM [Product Details View] pdv
-                     INNER JOIN ProductsToReleaseKeys ptr
-                                ON ptr.gogId = pdv.productId
-                     INNER JOIN InstalledBaseProducts ibp
-                                ON ibp.productId = pdv.productId
-            )SQL";
-
-            std::unordered_map<std::string, std::any> params;
+    void GogGalaxyService::setScanJobs(const unsigned int jobs) { this->scanJobs = jobs; }
+
+    bool GogGalaxyService::isDosProduct(const ProductDetails &product) {
+        // A DOS game ships its own DOSBOX folder, so we look for an entry of installationPath whose path contains it.
+        // If the installation path itself contains DOSBOX, any entry matches
+        const bool pathMatches = product.installationPath.find("DOSBOX") != std::string::npos;
+        try {
+            return DirectoryScanner::containsEntry(product.installationPath, [&](const std::string_view name) {
+                return pathMatches || name.find("DOSBOX") != std::string_view::npos;
+            });
+        } catch (const std::exception &e) {
+            std::cerr << "Error scanning directory: " << e.what() << std::endl;
+        }
+        return false;
+    }
 
-            if (releaseKey.has_value()) {
-                query += " WHERE ptr.releaseKey = :releaseKey;";
-                params.insert({"releaseKey", releaseKey.value()});
+    void GogGalaxyService::setDosClassificationCache(const std::string &cachePath) {
+        try {
+            this->dosClassificationCache = std::make_unique<DosClassificationCache>(cachePath);
+        } catch (const std::exception &e) {
+            std::cerr << "Warning: Unable to open the DOS classification cache, games will be rescanned: " << e.what()
+                      << std::endl;
+            this->dosClassificationCache.reset();
+        }
+    }
+
+    std::vector<char> GogGalaxyService::classifyDosProducts(const std::vector<ProductDetails> &products) {
+        std::vector<char> isDos(products.size(), 0);
+        std::vector<std::optional<DosClassification>> updates(products.size());
+        const DosClassificationCache *cache = this->dosClassificationCache.get();
+        const size_t jobs = std::min<size_t>(
+                this->scanJobs != 0 ? this->scanJobs : std::max(1u, std::thread::hardware_concurrency()),
+                products.size());
+
+        // With a cache, an unchanged directory costs a single stat. Changed or unknown directories are scanned
+        // and their new classification is kept aside so it can be written once all workers are done
+        const auto classify = [&](const size_t i) {
+            DosClassification current;
+            current.installationPath = products[i].installationPath;
+            if (cache == nullptr || !DosClassificationCache::readDirectoryStamp(current)) {
+                isDos[i] = isDosProduct(products[i]);
+                return;
             }
-            else {
-                query += ";";
+            if (const auto *cached = cache->find(current)) {
+                isDos[i] = cached->isDos;
+                return;
+            }
+            try {
+                DosClassificationCache::classify(current);
+                isDos[i] = current.isDos;
+                updates[i] = std::move(current);
+            } catch (const std::exception &e) {
+                std::cerr << "Error scanning directory: " << e.what() << std::endl;
+            }
+        };
+
+        // Workers pick the next unclassified product until none are left, each result goes to its own slot
+        // so the original order is kept without any locking
+        std::atomic<size_t> next = 0;
+        const auto worker = [&] {
+            for (size_t i = next++; i < products.size(); i = next++) {
+                classify(i);
             }
+        };
+        {
+            std::vector<std::jthread> workers;
+            for (size_t i = 1; i < jobs; ++i) {
+                workers.emplace_back(worker);
+            }
+            worker();
+        }
 
-            auto result = this->sqlService.executeQuery<ProductDetails>(query, params);
-
-            // If showDosOnly is true, filter the results to only include DOS games
-            // To do this, we use DirectoryScanner to get all the listed files in installationPath
-            // and if it contains the folder DOSBOX, we add it to the result
-            if (showDosOnly) {
-                std::vector<ProductDetails> filteredResult;
-
-                for (const auto &product: result) {
-                    try {
-                        if (auto filesInPath = DirectoryScanner::scanDirectory(product.installationPath);
-                        std::ranges::any_of(filesInPath, [](const auto &file) {
-                            return file.path.find("DOSBOX") != std::string::npos;
-                        })) {
-                            filteredResult.push_back(product);
-                        }
-                    } catch (const std::exception &e) {
-                        std::cerr << "Error scanning directory: " << e.what() << std::endl;
-                    }
+        if (this->dosClassificationCache) {
+            std::vector<DosClassification> classifications;
+            for (auto &update: updates) {
+                if (update.has_value()) {
+                    classifications.push_back(std::move(*update));
                 }
+            }
+            try {
+                this->dosClassificationCache->store(classifications);
+            } catch (const std::exception &e) {
+                std::cerr << "Warning: Unable to update the DOS classification cache: " << e.what() << std::endl;
+            }
+        }
+        return isDos;
+    }
+
+    void GogGalaxyService::forEachProduct(const std::optional<std::string> &releaseKey, const bool showDosOnly,
+                                          const std::function<void(const ProductDetails &)> &callback) {
+        if (!this->validDatabase) {
+            throw GogGalaxyServiceException("Database connection is not open");
+        }
 
-                return filteredResult;
+        std::string query = R"SQL(
+            SELECT
+                pdv.productId,
+                pdv.title,
+                pdv.slug,
+                ptr.gogId,
+                ptr.releaseKey,
+                ibp.installationPath,
+                ibp.installationDate
+            FROM [Product Details View] pdv
+                 INNER JOIN ProductsToReleaseKeys ptr
+                            ON ptr.gogId = pdv.productId
+                 INNER JOIN InstalledBaseProducts ibp
+                            ON ibp.productId = pdv.productId
+        )SQL";
+        query += releaseKey.has_value() ? " WHERE ptr.releaseKey = :releaseKey;" : ";";
+
+        if (!showDosOnly) {
+            if (releaseKey.has_value()) {
+                this->sqlService.forEachRow<ProductDetails>(query, {releaseKey.value()}, callback);
             }
-            return result;
+            else {
+                this->sqlService.forEachRow<ProductDetails>(query, {}, callback);
+            }
+            return;
         }
-        throw GogGalaxyServiceException("Database connection is not open");
+
+        // Scanning the installation directories dominates, so all products are read first and scanned in parallel
+        const auto products = releaseKey.has_value()
+                                  ? this->sqlService.executeQuery<ProductDetails>(query, {releaseKey.value()})
+                                  : this->sqlService.executeQuery<ProductDetails>(query, {});
+        const auto isDos = this->classifyDosProducts(products);
+        for (size_t i = 0; i < products.size(); ++i) {
+            if (isDos[i]) {
+                callback(products[i]);
+            }
+        }
+    }
+
+    std::vector<ProductDetails> GogGalaxyService::getProducts(const std::optional<std::string> &releaseKey,
+                                                              const bool showDosOnly) {
+        std::vector<ProductDetails> result;
+        this->forEachProduct(releaseKey, showDosOnly, [&](const ProductDetails &product) {
+            result.push_back(product);
+        });
+        return result;
     }
 
     std::vector<GogUser> GogGalaxyService::getUsers() {
@@ -228,12 +310,27 @@ namespace DosboxStagingReplacer {
                 INNER JOIN PlayTaskTypes ptt ON pt.typeId = ptt.id
                 WHERE pt.gameReleaseKey = :gameReleaseKey;
             )SQL",
-                                                                             {{"gameReleaseKey", gameReleaseKey}});
+                                                                             {gameReleaseKey});
             return result;
         }
         throw GogGalaxyServiceException("Database connection is not open");
     }
 
+    SqlResultSet<PlayTaskInformationView>
+    GogGalaxyService::getPlayTaskViewsFromGameReleaseKey(const std::string_view gameReleaseKey) {
+        if (this->validDatabase) {
+            return this->sqlService.executeQueryView<PlayTaskInformationView>(R"SQL(
+                SELECT
+                    pt.id, pt.gameReleaseKey, pt.userId, pt."order", pt.typeId, ptt.type, pt.isPrimary
+                FROM PlayTasks pt
+                INNER JOIN PlayTaskTypes ptt ON pt.typeId = ptt.id
+                WHERE pt.gameReleaseKey = :gameReleaseKey;
+            )SQL",
+                                                                              {gameReleaseKey});
+        }
+        throw GogGalaxyServiceException("Database connection is not open");
+    }
+
     std::vector<PlayTaskLaunchParameters> GogGalaxyService::getPlayTaskLaunchParameters() {
         if (this->validDatabase) {
             auto result = this->sqlService.executeQuery<PlayTaskLaunchParameters>(R"SQL(
@@ -255,7 +352,7 @@ namespace DosboxStagingReplacer {
                 FROM PlayTaskLaunchParameters ptlp
                 WHERE ptlp.playTaskId = :playTaskId;
             )SQL",
-                                                                                  {{"playTaskId", playTaskId}});
+                                                                                  {playTaskId});
             return result;
         }
         throw GogGalaxyServiceException("Database connection is not open");
@@ -296,7 +393,32 @@ namespace DosboxStagingReplacer {
                 UPDATE ProductSettings
                 SET customLaunchParameters = :enabled
                 WHERE gameReleaseKey = :releaseKey;
-            )SQL", {{"enabled", enabled}, {"releaseKey", gameReleaseKey}});
+            )SQL", {enabled, gameReleaseKey});
+            return;
+        }
+        throw GogGalaxyServiceException("Database connection is not open");
+    }
+
+    void GogGalaxyService::executeBatch(const std::function<void()> &operations) {
+        if (this->validDatabase) {
+            // Already inside a batch, the outer call owns the transaction
+            if (this->sqlService.isTransactionActive()) {
+                operations();
+                return;
+            }
+
+            this->sqlService.beginTransaction();
+            try {
+                operations();
+                this->sqlService.commitTransaction();
+            } catch (...) {
+                try {
+                    this->sqlService.rollbackTransaction();
+                } catch (const std::exception &e) {
+                    std::cerr << "Error rolling back batch: " << e.what() << std::endl;
+                }
+                throw;
+            }
             return;
         }
         throw GogGalaxyServiceException("Database connection is not open");
@@ -5,8 +5,11 @@
 #ifndef SERVICE_H
 #define SERVICE_H
 
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include "DosClassificationCache.h"
 #include "SqlService.h"
 #include "StatementParser.h"
 
@@ -21,10 +24,14 @@ namespace DosboxStagingReplacer {
     class GogGalaxyService {
         SqlLiteService sqlService;
         bool validDatabase = false;
+        unsigned int scanJobs = 0;
+        std::unique_ptr<DosClassificationCache> dosClassificationCache;
 
         void disableAllPlayTaskFor(const std::string& gameReleaseKey);
         PlayTaskInformation insertPlayTask(int64_t userId, int new_order, const PlayTaskInformation &playTask);
         void insertPlayTaskLaunchParameters(const PlayTaskInformation &playTask, const PlayTaskLaunchParameters &launchParameters);
+        static bool isDosProduct(const ProductDetails &product);
+        std::vector<char> classifyDosProducts(const std::vector<ProductDetails> &products);
 
     public:
         /**
@@ -65,6 +72,22 @@ namespace DosboxStagingReplacer {
          */
         void setConnectionString(const std::string &connectionString);
 
+        /**
+         * @brief Sets how many installation directories are scanned at the same time when filtering DOS games.
+         * @param jobs The number of worker threads, 0 uses one per hardware thread.
+         */
+        void setScanJobs(unsigned int jobs);
+
+        /**
+         * @brief Remembers which products are DOS games across runs.
+         *
+         * Once set, filtering DOS games only scans installation directories that changed since they were last
+         * classified. If the cache cannot be opened a warning is printed and DOS games are detected without it.
+         *
+         * @param cachePath Path to the cache database file, it is created if it does not exist yet.
+         */
+        void setDosClassificationCache(const std::string &cachePath);
+
         /**
          * @brief Retrieves all products in the database.
          * @param releaseKey If provided, only returns product information for that releaseKey
@@ -73,6 +96,21 @@ namespace DosboxStagingReplacer {
          */
         std::vector<ProductDetails> getProducts(const std::optional<std::string> &releaseKey = {}, bool showDosOnly = true);
 
+        /**
+         * @brief Streams the products in the database to a callback, one row at a time.
+         *
+         * Unlike getProducts, no result vector is built, each product is handed over as soon as it is read.
+         * When showDosOnly is set the products are read first so their directories can be scanned in parallel,
+         * they are still passed to the callback in query order.
+         * The ProductDetails reference is only valid for the duration of the call.
+         *
+         * @param releaseKey If provided, only returns product information for that releaseKey
+         * @param showDosOnly If true, only DOS games are passed to the callback.
+         * @param callback Receives every matching product.
+         */
+        void forEachProduct(const std::optional<std::string> &releaseKey, bool showDosOnly,
+                            const std::function<void(const ProductDetails &)> &callback);
+
         /**
          * @brief Retrieves all users in the database.
          * @return A vector of GogUser objects.
@@ -98,6 +136,14 @@ namespace DosboxStagingReplacer {
          */
         std::vector<PlayTaskInformation> getPlayTasksFromGameReleaseKey(std::string gameReleaseKey);
 
+        /**
+         * @brief Retrieves play tasks associated with a specific game release key as read-only views.
+         * Lighter than getPlayTasksFromGameReleaseKey, the text of every row lives in the returned result set.
+         * @param gameReleaseKey The release key of the game.
+         * @return A result set of PlayTaskInformationView objects.
+         */
+        SqlResultSet<PlayTaskInformationView> getPlayTaskViewsFromGameReleaseKey(std::string_view gameReleaseKey);
+
         /**
          * @brief Retrieves all play task launch parameters from the database.
          * @return A vector of PlayTaskLaunchParameters objects.
@@ -133,6 +179,17 @@ namespace DosboxStagingReplacer {
          * (false).
          */
         void setCustomLaunchParametersForProduct(const std::string &gameReleaseKey, const bool enabled);
+
+        /**
+         * @brief Runs a set of database operations as a single batch.
+         *
+         * The operations are wrapped in one transaction that is committed once all of them succeed.
+         * If any of them throws, the transaction is rolled back and the exception is rethrown so the
+         * database is never left partially modified. Nested calls join the batch that is already running.
+         *
+         * @param operations The operations to run, typically a series of addPlayTask calls.
+         */
+        void executeBatch(const std::function<void()> &operations);
     };
 
     /**
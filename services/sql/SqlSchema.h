@@ -0,0 +1,284 @@
+#ifndef SQLSCHEMA_H
+#define SQLSCHEMA_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "sqlite3.h"
+
+namespace DosboxStagingReplacer {
+
+    enum class DataResultDataType { Number, String, Boolean };
+
+    /**
+     * @brief Bump allocator for the text of a result set.
+     *
+     * Text is copied into large blocks that are only released together with the arena,
+     * so storing a value costs a memcpy instead of a heap allocation.
+     */
+    class SqlArena {
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char *cursor = nullptr;
+        size_t remaining = 0;
+        size_t blockSize;
+
+    public:
+        /**
+         * @brief Constructs an empty arena, no memory is reserved until the first value is stored.
+         * @param blockSize The size of each block, larger values are given a block of their own.
+         */
+        explicit SqlArena(const size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+
+        SqlArena(SqlArena &&other) noexcept :
+            blocks(std::move(other.blocks)), cursor(std::exchange(other.cursor, nullptr)),
+            remaining(std::exchange(other.remaining, 0)), blockSize(other.blockSize) {}
+
+        SqlArena &operator=(SqlArena &&other) noexcept {
+            this->blocks = std::move(other.blocks);
+            this->cursor = std::exchange(other.cursor, nullptr);
+            this->remaining = std::exchange(other.remaining, 0);
+            this->blockSize = other.blockSize;
+            return *this;
+        }
+
+        /**
+         * @brief Copies a value into the arena.
+         * @param value The value to copy.
+         * @return A view of the copy, valid for as long as the arena lives.
+         */
+        std::string_view store(const std::string_view value) {
+            if (value.empty()) {
+                return {};
+            }
+            if (value.size() > this->remaining) {
+                const size_t size = std::max(this->blockSize, value.size());
+                this->blocks.push_back(std::make_unique<char[]>(size));
+                this->cursor = this->blocks.back().get();
+                this->remaining = size;
+            }
+            char *copy = this->cursor;
+            std::memcpy(copy, value.data(), value.size());
+            this->cursor += value.size();
+            this->remaining -= value.size();
+            return {copy, value.size()};
+        }
+
+        /**
+         * @brief Returns the number of blocks allocated so far.
+         */
+        [[nodiscard]] size_t getBlockCount() const { return this->blocks.size(); }
+    };
+
+    /**
+     * @brief Compile-time descriptor of a single column of a SqlDataResult model.
+     *
+     * Models list their descriptors in a static constexpr fields() function, which is then used to
+     * decode rows, bind parameters and export values without any per-model code.
+     *
+     * @tparam T The model the field belongs to.
+     * @tparam M The member type, one of int, int64_t, bool, std::string or std::string_view.
+     */
+    template<typename T, typename M>
+    struct SqlField {
+        std::string_view name;
+        M T::*member;
+        /// Alternative column name mapped to the same member, e.g. an expression that was not aliased
+        std::string_view alias = {};
+    };
+
+    template<typename T, typename M>
+    SqlField(std::string_view, M T::*) -> SqlField<T, M>;
+
+    template<typename T, typename M>
+    SqlField(std::string_view, M T::*, std::string_view) -> SqlField<T, M>;
+
+    /**
+     * @brief A model whose columns are described by a static constexpr fields() tuple of SqlField.
+     */
+    template<typename T>
+    concept SqlSchemaModel = requires { std::tuple_size<decltype(T::fields())>::value; };
+
+    /**
+     * @brief Returns true if any field of the model is a std::string_view.
+     * Such models do not own their text and can only be read where the text is kept alive.
+     */
+    template<SqlSchemaModel T>
+    constexpr bool hasSqlViewFields() {
+        return std::apply(
+                [](const auto &...field) {
+                    return (std::is_same_v<std::remove_cvref_t<decltype(field.member)>, std::string_view T::*> || ...);
+                },
+                T::fields());
+    }
+
+    /**
+     * @brief Returns the data type used when exporting a member of type M.
+     */
+    template<typename M>
+    constexpr DataResultDataType sqlFieldDataType() {
+        if constexpr (std::is_same_v<M, bool>) {
+            return DataResultDataType::Boolean;
+        } else if constexpr (std::is_integral_v<M>) {
+            return DataResultDataType::Number;
+        } else {
+            static_assert(std::is_same_v<M, std::string> || std::is_same_v<M, std::string_view>,
+                          "Unsupported SqlField member type");
+            return DataResultDataType::String;
+        }
+    }
+
+    /**
+     * @brief Calls a function once for every field descriptor of a model, in declaration order.
+     * @param function Callable taking a SqlField.
+     */
+    template<SqlSchemaModel T, typename F>
+    constexpr void forEachSqlField(F &&function) {
+        std::apply([&](const auto &...field) { (function(field), ...); }, T::fields());
+    }
+
+    /**
+     * @brief Reads a column of the current row into a member.
+     *
+     * NULL text columns are read as empty strings. std::string_view members are copied into the arena
+     * when one is given, otherwise they point into SQLite's own buffer and are only valid until the next step.
+     */
+    template<typename M>
+    void readSqliteColumn(M &value, sqlite3_stmt *stmt, const int column, SqlArena *arena = nullptr) {
+        if constexpr (std::is_same_v<M, bool>) {
+            value = sqlite3_column_int(stmt, column) != 0;
+        } else if constexpr (std::is_same_v<M, int64_t>) {
+            value = sqlite3_column_int64(stmt, column);
+        } else if constexpr (std::is_integral_v<M>) {
+            value = sqlite3_column_int(stmt, column);
+        } else if constexpr (std::is_same_v<M, std::string_view>) {
+            const auto *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, column));
+            const std::string_view columnValue = text ? std::string_view(text, sqlite3_column_bytes(stmt, column))
+                                                      : std::string_view();
+            value = arena ? arena->store(columnValue) : columnValue;
+        } else {
+            static_assert(std::is_same_v<M, std::string>, "Unsupported SqlField member type");
+            const auto *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, column));
+            value.assign(text ? text : "", sqlite3_column_bytes(stmt, column));
+        }
+    }
+
+    /**
+     * @brief Binds a member to a statement parameter.
+     * Text is bound without copying, the member must outlive the statement's execution.
+     */
+    template<typename M>
+    void bindSqliteValue(sqlite3_stmt *stmt, const int index, const M &value) {
+        if constexpr (std::is_same_v<M, int64_t>) {
+            sqlite3_bind_int64(stmt, index, value);
+        } else if constexpr (std::is_integral_v<M>) {
+            sqlite3_bind_int(stmt, index, value);
+        } else {
+            static_assert(std::is_same_v<M, std::string> || std::is_same_v<M, std::string_view>,
+                          "Unsupported SqlField member type");
+            sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+        }
+    }
+
+    /**
+     * @brief Maps the columns of a SQLite result set to the model fields they fill.
+     *
+     * Column names are resolved against the model's field descriptors once per result set,
+     * rows are then decoded through a plain index to setter loop without comparing any column names.
+     */
+    template<SqlSchemaModel T>
+    class SqliteColumnPlan {
+        using Setter = void (*)(T &result, sqlite3_stmt *stmt, int column, SqlArena *arena);
+
+        template<size_t I>
+        static void setField(T &result, sqlite3_stmt *stmt, const int column, SqlArena *arena) {
+            constexpr auto field = std::get<I>(T::fields());
+            readSqliteColumn(result.*field.member, stmt, column, arena);
+        }
+
+        template<size_t... I>
+        static constexpr std::array<Setter, sizeof...(I)> makeSetters(std::index_sequence<I...>) {
+            return {&setField<I>...};
+        }
+
+        static constexpr auto setters = makeSetters(std::make_index_sequence<std::tuple_size_v<decltype(T::fields())>>{});
+
+        std::vector<std::pair<int, Setter>> bindings;
+
+    public:
+        /**
+         * @brief Resolves the plan for a statement. Columns without a matching field are ignored.
+         * @param stmt The prepared statement to resolve the columns of.
+         */
+        explicit SqliteColumnPlan(sqlite3_stmt *stmt) {
+            for (int i = 0; i < sqlite3_column_count(stmt); ++i) {
+                const std::string_view columnName = sqlite3_column_name(stmt, i);
+                size_t fieldIndex = 0;
+                bool matched = false;
+                forEachSqlField<T>([&](const auto &field) {
+                    if (!matched && (field.name == columnName || (!field.alias.empty() && field.alias == columnName))) {
+                        this->bindings.emplace_back(i, setters[fieldIndex]);
+                        matched = true;
+                    }
+                    fieldIndex++;
+                });
+            }
+        }
+
+        /**
+         * @brief Fills an object with the statement's current row.
+         * @param result The object to fill.
+         * @param stmt The statement positioned on the row to read.
+         * @param arena The arena receiving std::string_view columns, if any.
+         */
+        void apply(T &result, sqlite3_stmt *stmt, SqlArena *arena = nullptr) const {
+            for (const auto &[column, setter]: this->bindings) {
+                setter(result, stmt, column, arena);
+            }
+        }
+    };
+
+    /**
+     * @brief Read-only rows of a query together with the arena holding their text.
+     *
+     * Meant for models with std::string_view fields, the views stay valid for as long as the result set lives
+     * and all of the text is freed at once with it.
+     *
+     * @tparam T The row type.
+     */
+    template<SqlSchemaModel T>
+    class SqlResultSet {
+        SqlArena arena;
+        std::vector<T> rows;
+
+        friend class SqlLiteService;
+
+    public:
+        SqlResultSet() = default;
+        SqlResultSet(SqlResultSet &&) noexcept = default;
+        SqlResultSet &operator=(SqlResultSet &&) noexcept = default;
+        SqlResultSet(const SqlResultSet &) = delete;
+        SqlResultSet &operator=(const SqlResultSet &) = delete;
+
+        [[nodiscard]] auto begin() const { return this->rows.begin(); }
+        [[nodiscard]] auto end() const { return this->rows.end(); }
+        [[nodiscard]] size_t size() const { return this->rows.size(); }
+        [[nodiscard]] bool empty() const { return this->rows.empty(); }
+        const T &operator[](const size_t index) const { return this->rows[index]; }
+
+        /**
+         * @brief Returns the arena holding the text of the rows.
+         */
+        [[nodiscard]] const SqlArena &getArena() const { return this->arena; }
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // SQLSCHEMA_H
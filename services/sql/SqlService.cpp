@@ -3,6 +3,7 @@
 //
 
 #include <cstdint>
+#include <type_traits>
 #ifndef SQL_CPP
 #define SQL_CPP
 
@@ -51,6 +52,31 @@ namespace DosboxStagingReplacer {
         throw SqlServiceException("Connection is not open");
     }
 
+    void SqlService::beginTransaction() {
+        if (this->connectedFlag) {
+            throw SqlServiceException("Method not implemented");
+        }
+        throw SqlServiceException("Connection is not open");
+    }
+
+    void SqlService::commitTransaction() {
+        if (this->connectedFlag) {
+            throw SqlServiceException("Method not implemented");
+        }
+        throw SqlServiceException("Connection is not open");
+    }
+
+    void SqlService::rollbackTransaction() {
+        if (this->connectedFlag) {
+            throw SqlServiceException("Method not implemented");
+        }
+        throw SqlServiceException("Connection is not open");
+    }
+
+    bool SqlService::isTransactionActive() const {
+        return this->transactionFlag;
+    }
+
     SqlService::~SqlService() {
         if (this->connectedFlag) {
             this->SqlService::closeConnection();
@@ -70,15 +96,25 @@ namespace DosboxStagingReplacer {
     }
 
     void SqlLiteService::openConnection(const std::string &connectionString) {
+        this->openDatabase(connectionString, SQLITE_OPEN_READWRITE);
+    }
+
+    void SqlLiteService::createConnection(const std::string &connectionString) {
+        this->openDatabase(connectionString, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    }
+
+    void SqlLiteService::openDatabase(const std::string &connectionString, const int flags) {
         if (!connectionString.empty()) {
             this->connectionString = connectionString;
-            this->connection = sqlite3_open_v2(this->connectionString.c_str(), &this->db, SQLITE_OPEN_READWRITE, nullptr);
+            this->connection = sqlite3_open_v2(this->connectionString.c_str(), &this->db, flags, nullptr);
             if (this->connection != SQLITE_OK) {
                 std::cerr << "Error opening database: " << sqlite3_errmsg(this->db) << std::endl;
                 sqlite3_close(this->db);
                 throw SqlLiteServiceException(sqlite3_errmsg(this->db));
             }
             this->connectedFlag = true;
+            this->statementCacheHits = 0;
+            this->statementCacheMisses = 0;
         }
     }
 
@@ -88,19 +124,37 @@ namespace DosboxStagingReplacer {
             throw SqlLiteServiceException("Connection is not open");
         }
 
-        if (query.length() > static_cast<size_t>(std::numeric_limits<int>::max())) {
-            throw std::length_error("SQL query string too long for sqlite3_prepare_v2");
+        sqlite3_stmt *stmt = this->prepareStatement(query).stmt;
+        this->bindParameters(stmt, params);
+
+        // Execute the statement
+        if (const int rc = sqlite3_step(stmt); rc != SQLITE_DONE) {
+            std::cerr << "Error executing query: " << sqlite3_errmsg(this->db) << std::endl;
+            releaseStatement(stmt);
+            throw SqlLiteServiceException(sqlite3_errmsg(this->db));
         }
+        releaseStatement(stmt);
+    }
 
-        sqlite3_stmt *stmt = nullptr;
-        int rc = sqlite3_prepare_v2(this->db, query.c_str(), static_cast<int>(query.length()), &stmt, nullptr);
-        if (rc != SQLITE_OK) {
-            std::cerr << "Error preparing statement: " << sqlite3_errmsg(this->db) << std::endl;
-            sqlite3_finalize(stmt);
+    void SqlLiteService::executeQuery(const std::string &query, const std::initializer_list<SqlParameter> params) {
+        if (!this->connectedFlag) {
+            throw SqlLiteServiceException("Connection is not open");
+        }
+
+        sqlite3_stmt *stmt = this->prepareStatement(query).stmt;
+        this->bindParameters(stmt, params);
+
+        // Execute the statement
+        if (const int rc = sqlite3_step(stmt); rc != SQLITE_DONE) {
+            std::cerr << "Error executing query: " << sqlite3_errmsg(this->db) << std::endl;
+            releaseStatement(stmt);
             throw SqlLiteServiceException(sqlite3_errmsg(this->db));
         }
+        releaseStatement(stmt);
+    }
 
-        // Bind parameters
+    void SqlLiteService::bindParameters(sqlite3_stmt *stmt,
+                                        const std::unordered_map<std::string, std::any> &params) const {
         for (int i = 1; i <= sqlite3_bind_parameter_count(stmt); ++i) {
             const char *paramName = sqlite3_bind_parameter_name(stmt, i);
             if (!paramName)
@@ -133,24 +187,121 @@ namespace DosboxStagingReplacer {
                 sqlite3_bind_int(stmt, i, std::any_cast<bool>(value));
             } else {
                 std::cerr << "Unsupported type for key: " << key << std::endl;
-                sqlite3_finalize(stmt);
+                releaseStatement(stmt);
                 throw SqlLiteServiceException("Unsupported parameter type");
             }
         }
+    }
 
-        // Execute the statement
-        rc = sqlite3_step(stmt);
-        if (rc != SQLITE_DONE) {
-            std::cerr << "Error executing query: " << sqlite3_errmsg(this->db) << std::endl;
+    void SqlLiteService::bindParameters(sqlite3_stmt *stmt, const std::initializer_list<SqlParameter> params) const {
+        if (static_cast<int>(params.size()) != sqlite3_bind_parameter_count(stmt)) {
+            std::cerr << "Expected " << sqlite3_bind_parameter_count(stmt) << " SQL parameters but got "
+                      << params.size() << std::endl;
+            releaseStatement(stmt);
+            throw SqlLiteServiceException("Parameter count does not match the query");
+        }
+
+        int index = 1;
+        for (const auto &param: params) {
+            std::visit(
+                    [&]<typename V>(const V &value) {
+                        if constexpr (std::is_same_v<V, std::nullptr_t>) {
+                            sqlite3_bind_null(stmt, index);
+                        } else if constexpr (std::is_same_v<V, int> || std::is_same_v<V, bool>) {
+                            sqlite3_bind_int(stmt, index, value);
+                        } else if constexpr (std::is_same_v<V, int64_t>) {
+                            sqlite3_bind_int64(stmt, index, value);
+                        } else if constexpr (std::is_same_v<V, double>) {
+                            sqlite3_bind_double(stmt, index, value);
+                        } else {
+                            // The caller keeps the text alive for the whole query, so SQLite can use it in place
+                            sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()),
+                                              SQLITE_STATIC);
+                        }
+                    },
+                    param);
+            index++;
+        }
+    }
+
+    void SqlLiteService::releaseStatement(sqlite3_stmt *stmt) {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+
+    void SqlLiteService::beginTransaction() {
+        if (this->transactionFlag) {
+            throw SqlLiteServiceException("A transaction is already active");
+        }
+        this->executeQuery("BEGIN IMMEDIATE;", {});
+        this->transactionFlag = true;
+    }
+
+    void SqlLiteService::commitTransaction() {
+        if (!this->transactionFlag) {
+            throw SqlLiteServiceException("There is no active transaction to commit");
+        }
+        this->executeQuery("COMMIT;", {});
+        this->transactionFlag = false;
+    }
+
+    void SqlLiteService::rollbackTransaction() {
+        if (!this->transactionFlag) {
+            throw SqlLiteServiceException("There is no active transaction to roll back");
+        }
+        // The transaction is considered finished even if ROLLBACK fails, SQLite may have already
+        // rolled it back on its own (e.g. after an I/O error)
+        this->transactionFlag = false;
+        if (sqlite3_get_autocommit(this->db) == 0) {
+            this->executeQuery("ROLLBACK;", {});
+        }
+    }
+
+    SqlLiteService::CachedStatement &SqlLiteService::prepareStatement(const std::string &query) {
+        if (const auto it = this->statementCache.find(query); it != this->statementCache.end()) {
+            this->statementCacheHits++;
+            releaseStatement(it->second.stmt);
+            return it->second;
+        }
+
+        if (query.length() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            throw std::length_error("SQL query string too long for sqlite3_prepare_v2");
+        }
+
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(this->db, query.c_str(), static_cast<int>(query.length()), &stmt, nullptr) !=
+            SQLITE_OK) {
+            std::cerr << "Error preparing statement: " << sqlite3_errmsg(this->db) << std::endl;
             sqlite3_finalize(stmt);
             throw SqlLiteServiceException(sqlite3_errmsg(this->db));
         }
+        this->statementCacheMisses++;
+        return this->statementCache.emplace(query, CachedStatement{stmt}).first->second;
+    }
+
+    void SqlLiteService::finalizeStatements() {
+        for (const auto &[query, statement]: this->statementCache) {
+            sqlite3_finalize(statement.stmt);
+        }
+        this->statementCache.clear();
+    }
+
+    size_t SqlLiteService::getStatementCacheHits() const {
+        return this->statementCacheHits;
+    }
+
+    size_t SqlLiteService::getStatementCacheMisses() const {
+        return this->statementCacheMisses;
     }
 
     void SqlLiteService::closeConnection() {
         if (this->connectedFlag) {
+            // Statements must be finalized before sqlite3_close, otherwise the connection stays busy
+            // Closing with an active transaction makes SQLite roll it back
+            this->finalizeStatements();
             sqlite3_close(this->db);
             this->connectedFlag = false;
+            this->transactionFlag = false;
         } else {
             std::cerr << "Connection is already closed" << std::endl;
         }
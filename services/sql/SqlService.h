@@ -8,11 +8,20 @@
 #define SQL_H
 
 #include <any>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
+#include "SqlSchema.h"
 #include "sqlite3.h"
 
 namespace DosboxStagingReplacer {
@@ -39,6 +48,7 @@ namespace DosboxStagingReplacer {
     protected:
         std::string connectionString;
         bool connectedFlag = false;
+        bool transactionFlag = false;
 
     public:
         /**
@@ -94,8 +104,35 @@ namespace DosboxStagingReplacer {
          * @param params Named parameters to bind in the query.
          */
         virtual void executeQuery(const std::string &query, const std::unordered_map<std::string, std::any> &params);
+
+        /**
+         * @brief Starts a transaction, writes made until commit or rollback are applied as a single unit.
+         */
+        virtual void beginTransaction();
+
+        /**
+         * @brief Commits the active transaction.
+         */
+        virtual void commitTransaction();
+
+        /**
+         * @brief Rolls back the active transaction.
+         */
+        virtual void rollbackTransaction();
+
+        /**
+         * @brief Checks whether a transaction is currently active.
+         * @return true if a transaction is active, false otherwise.
+         */
+        [[nodiscard]] bool isTransactionActive() const;
     };
 
+    /**
+     * @brief A value bound to a query parameter.
+     * Strings are borrowed rather than copied, the referenced text must stay alive until the query returns.
+     */
+    using SqlParameter = std::variant<std::nullptr_t, int, int64_t, double, bool, std::string_view>;
+
     /**
      * @brief Supported database engines.
      */
@@ -124,6 +161,141 @@ namespace DosboxStagingReplacer {
         int connection = 0;
         sqlite3 *db = nullptr;
 
+        /**
+         * @brief A prepared statement of the statement cache, together with what was learned from running it.
+         */
+        struct CachedStatement {
+            sqlite3_stmt *stmt = nullptr;
+
+            // Number of rows returned by the last run, used to size result vectors
+            size_t rowCountHint = 0;
+
+            // Column plans of the statement, one per result type it has been read into
+            std::unordered_map<std::type_index, std::shared_ptr<const void>> columnPlans;
+
+            /**
+             * @brief Returns the column plan for reading the statement into T, resolving it on first use.
+             * @tparam T The result data type.
+             * @return The plan, owned by the cached statement.
+             */
+            template<SqlSchemaModel T>
+            const SqliteColumnPlan<T> &getColumnPlan() {
+                auto &plan = this->columnPlans[std::type_index(typeid(T))];
+                if (!plan) {
+                    plan = std::make_shared<const SqliteColumnPlan<T>>(this->stmt);
+                }
+                return *static_cast<const SqliteColumnPlan<T> *>(plan.get());
+            }
+        };
+
+        // Prepared statements are kept per connection and keyed by their SQL text so repeated queries
+        // skip the parse/plan step of sqlite3_prepare_v2
+        std::unordered_map<std::string, CachedStatement> statementCache;
+        size_t statementCacheHits = 0;
+        size_t statementCacheMisses = 0;
+
+        /**
+         * @brief Opens the SQLite database with the given sqlite3_open_v2 flags.
+         * @param connectionString Path to the SQLite file.
+         * @param flags The SQLITE_OPEN_* flags.
+         */
+        void openDatabase(const std::string &connectionString, int flags);
+
+        /**
+         * @brief Returns a ready to use prepared statement for the query, reusing a cached one if available.
+         * A reused statement is reset and has its bindings cleared before being returned.
+         * @param query The SQL query string.
+         * @return The cached statement, owned by the statement cache.
+         */
+        CachedStatement &prepareStatement(const std::string &query);
+
+        /**
+         * @brief Finalizes every cached prepared statement and empties the cache.
+         */
+        void finalizeStatements();
+
+        /**
+         * @brief Binds named parameters to a statement by looking up each parameter name in the map.
+         * @param stmt The statement to bind to.
+         * @param params Named parameters to bind in the query.
+         */
+        void bindParameters(sqlite3_stmt *stmt, const std::unordered_map<std::string, std::any> &params) const;
+
+        /**
+         * @brief Binds parameters to a statement by index, in the order they first appear in the query.
+         * @param stmt The statement to bind to.
+         * @param params Parameters to bind in the query.
+         */
+        void bindParameters(sqlite3_stmt *stmt, std::initializer_list<SqlParameter> params) const;
+
+        /**
+         * @brief Binds each named parameter to the model field with the same name.
+         * @tparam M The model type, described by SqlField descriptors.
+         * @param stmt The statement to bind to.
+         * @param model The model providing the values, it must outlive the statement's execution.
+         */
+        template<SqlSchemaModel M>
+        void bindParameters(sqlite3_stmt *stmt, const M &model) const {
+            for (int i = 1; i <= sqlite3_bind_parameter_count(stmt); ++i) {
+                const char *paramName = sqlite3_bind_parameter_name(stmt, i);
+                if (!paramName)
+                    continue;
+
+                const std::string_view key = std::string_view(paramName).substr(1); // remove colon
+                bool bound = false;
+                forEachSqlField<M>([&](const auto &field) {
+                    if (!bound && field.name == key) {
+                        bindSqliteValue(stmt, i, model.*field.member);
+                        bound = true;
+                    }
+                });
+                if (!bound) {
+                    std::cerr << "Missing value for SQL parameter: " << key << std::endl;
+                }
+            }
+        }
+
+        /**
+         * @brief Steps a bound statement to completion and maps every row to an object.
+         * @tparam T The result data type.
+         * @param statement The prepared and bound statement.
+         * @param arena The arena receiving std::string_view columns, if any.
+         * @return A vector of deserialized objects of type T.
+         */
+        template<typename T>
+        std::vector<T> collectRows(CachedStatement &statement, SqlArena *arena = nullptr) {
+            sqlite3_stmt *stmt = statement.stmt;
+            auto result = std::vector<T>();
+            int rc;
+
+            // The previous run of the same statement is a good guess of how many rows this one returns
+            result.reserve(statement.rowCountHint);
+
+            // Column names are resolved once per statement, rows are then constructed directly inside the
+            // result vector and filled in place
+            const SqliteColumnPlan<T> &plan = statement.getColumnPlan<T>();
+            while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+                plan.apply(result.emplace_back(), stmt, arena);
+            }
+            statement.rowCountHint = result.size();
+
+            if (rc != SQLITE_DONE) {
+                std::cerr << "Error executing query: " << sqlite3_errmsg(this->db) << std::endl;
+                this->releaseStatement(stmt);
+                throw SqlLiteServiceException(sqlite3_errmsg(this->db));
+            }
+
+            this->releaseStatement(stmt);
+            return result;
+        }
+
+        /**
+         * @brief Returns a statement to the cache once it is no longer stepped.
+         * The statement is reset and its bindings cleared so no borrowed parameter stays referenced.
+         * @param stmt The statement to release.
+         */
+        static void releaseStatement(sqlite3_stmt *stmt);
+
     public:
         /**
          * @brief Opens a SQLite database connection.
@@ -131,6 +303,12 @@ namespace DosboxStagingReplacer {
          */
         void openConnection(const std::string &connectionString) override;
 
+        /**
+         * @brief Opens a SQLite database connection, creating the database file if it does not exist yet.
+         * @param connectionString Path to the SQLite file.
+         */
+        void createConnection(const std::string &connectionString);
+
         /**
          * @brief Closes the SQLite database connection.
          */
@@ -144,78 +322,113 @@ namespace DosboxStagingReplacer {
          * @return A vector of deserialized objects of type T.
          */
         template<typename T>
-        std::vector<T> executeQuery(const std::string &query, std::unordered_map<std::string, std::any> params) {
-            auto result = std::vector<T>();
-
+        std::vector<T> executeQuery(const std::string &query, const std::unordered_map<std::string, std::any> &params) {
+            static_assert(!hasSqlViewFields<T>(), "Models with std::string_view fields are read with executeQueryView");
             if (!this->connectedFlag) {
                 throw SqlLiteServiceException("Connection is not open");
             }
 
-            if (query.length() > static_cast<size_t>(std::numeric_limits<int>::max())) {
-                throw std::length_error("SQL query string too long for sqlite3_prepare_v2");
-            }
+            CachedStatement &statement = this->prepareStatement(query);
+            this->bindParameters(statement.stmt, params);
+            return this->collectRows<T>(statement);
+        }
 
-            sqlite3_stmt *stmt = nullptr;
-            int rc = sqlite3_prepare_v2(this->db, query.c_str(), static_cast<int>(query.length()), &stmt, nullptr);
-            if (rc != SQLITE_OK) {
-                std::cerr << "Error preparing statement: " << sqlite3_errmsg(this->db) << std::endl;
-                sqlite3_finalize(stmt);
-                throw SqlLiteServiceException(sqlite3_errmsg(this->db));
+        /**
+         * @brief Executes a query and maps results to objects, binding parameters by index.
+         *
+         * Parameters are bound in the order they first appear in the query, so
+         * `WHERE a = :a AND b = :b` takes `{a, b}`. Strings are bound without being copied.
+         *
+         * @tparam T The result data type.
+         * @param query The SQL query string.
+         * @param params Parameters to bind in the query.
+         * @return A vector of deserialized objects of type T.
+         */
+        template<typename T>
+        std::vector<T> executeQuery(const std::string &query, std::initializer_list<SqlParameter> params) {
+            static_assert(!hasSqlViewFields<T>(), "Models with std::string_view fields are read with executeQueryView");
+            if (!this->connectedFlag) {
+                throw SqlLiteServiceException("Connection is not open");
             }
 
-            // Bind parameters
-            for (int i = 1; i <= sqlite3_bind_parameter_count(stmt); ++i) {
-                const char *paramName = sqlite3_bind_parameter_name(stmt, i);
-                if (!paramName)
-                    continue;
-
-                std::string key = paramName;
-                if (key[0] == ':')
-                    key = key.substr(1); // remove colon
-
-                auto it = params.find(key);
-                if (it == params.end()) {
-                    std::cerr << "Missing value for SQL parameter: " << key << std::endl;
-                    continue;
-                }
+            CachedStatement &statement = this->prepareStatement(query);
+            this->bindParameters(statement.stmt, params);
+            return this->collectRows<T>(statement);
+        }
 
-                if (const std::any &value = it->second; value.type() == typeid(int)) {
-                    sqlite3_bind_int(stmt, i, std::any_cast<int>(value));
-                } else if (value.type() == typeid(double)) {
-                    sqlite3_bind_double(stmt, i, std::any_cast<double>(value));
-                } else if (value.type() == typeid(std::string)) {
-                    sqlite3_bind_text(stmt, i, std::any_cast<std::string>(value).c_str(), -1, SQLITE_TRANSIENT);
-                } else if (value.type() == typeid(const char *)) {
-                    sqlite3_bind_text(stmt, i, std::any_cast<const char *>(value), -1, SQLITE_TRANSIENT);
-                } else if (value.type() == typeid(nullptr)) {
-                    sqlite3_bind_null(stmt, i);
-                } else {
-                    std::cerr << "Unsupported type for key: " << key << std::endl;
-                    sqlite3_finalize(stmt);
-                    throw SqlLiteServiceException("Unsupported parameter type");
-                }
+        /**
+         * @brief Executes a read-only query into an arena backed result set.
+         *
+         * std::string_view fields of T point into an arena owned by the result set instead of owning their
+         * text, so reading a row costs no heap allocation and the whole result is freed in one go.
+         *
+         * @tparam T The result data type.
+         * @param query The SQL query string.
+         * @param params Parameters to bind in the query, in the order they first appear in the query.
+         * @return The rows and the arena holding their text.
+         */
+        template<SqlSchemaModel T>
+        SqlResultSet<T> executeQueryView(const std::string &query, std::initializer_list<SqlParameter> params) {
+            if (!this->connectedFlag) {
+                throw SqlLiteServiceException("Connection is not open");
             }
 
-            std::vector<std::string> columns;
-            columns.reserve(sqlite3_column_count(stmt));
-            for (int i = 0; i < sqlite3_column_count(stmt); ++i) {
-                columns.emplace_back(sqlite3_column_name(stmt, i));
+            CachedStatement &statement = this->prepareStatement(query);
+            this->bindParameters(statement.stmt, params);
+            SqlResultSet<T> resultSet;
+            resultSet.rows = this->collectRows<T>(statement, &resultSet.arena);
+            return resultSet;
+        }
+
+        /**
+         * @brief Executes a query and hands every row to a callback as soon as it is read.
+         *
+         * Rows are never collected, a single row object is refilled for each step of the statement so memory
+         * stays flat regardless of the result size. std::string_view fields point straight into SQLite's buffers
+         * and are only valid during the call. The callback may return false to stop reading early.
+         * The callback must not run the same query again while its rows are being iterated.
+         *
+         * @tparam T The result data type.
+         * @param query The SQL query string.
+         * @param params Parameters to bind in the query, in the order they first appear in the query.
+         * @param callback Callable taking a const T&, optionally returning bool.
+         */
+        template<typename T, typename F>
+        void forEachRow(const std::string &query, std::initializer_list<SqlParameter> params, F &&callback) {
+            if (!this->connectedFlag) {
+                throw SqlLiteServiceException("Connection is not open");
             }
 
-            while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-                auto datapoint_reference = T().fillFromStatement(stmt, columns, SqlEngine::SQLITE);
-                auto datapoint = std::any_cast<T&>(datapoint_reference);
-                result.push_back(datapoint);
+            CachedStatement &statement = this->prepareStatement(query);
+            sqlite3_stmt *stmt = statement.stmt;
+            this->bindParameters(stmt, params);
+
+            const SqliteColumnPlan<T> &plan = statement.getColumnPlan<T>();
+            T row{};
+            int rc;
+            try {
+                while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+                    plan.apply(row, stmt);
+                    if constexpr (std::is_same_v<std::invoke_result_t<F &, const T &>, bool>) {
+                        if (!callback(std::as_const(row))) {
+                            releaseStatement(stmt);
+                            return;
+                        }
+                    } else {
+                        callback(std::as_const(row));
+                    }
+                }
+            } catch (...) {
+                releaseStatement(stmt);
+                throw;
             }
 
             if (rc != SQLITE_DONE) {
                 std::cerr << "Error executing query: " << sqlite3_errmsg(this->db) << std::endl;
-                sqlite3_finalize(stmt);
+                releaseStatement(stmt);
                 throw SqlLiteServiceException(sqlite3_errmsg(this->db));
             }
-
-            sqlite3_finalize(stmt);
-            return result;
+            releaseStatement(stmt);
         }
 
         /**
@@ -225,6 +438,65 @@ namespace DosboxStagingReplacer {
          */
         void executeQuery(const std::string &query, const std::unordered_map<std::string, std::any> &params) override;
 
+        /**
+         * @brief Executes a query that does not return results, binding parameters by index.
+         * @param query The SQL query string.
+         * @param params Parameters to bind in the query, in the order they first appear in the query.
+         */
+        void executeQuery(const std::string &query, std::initializer_list<SqlParameter> params);
+
+        /**
+         * @brief Executes a query that does not return results, binding parameters from a model.
+         * Every named parameter is bound to the model field of the same name, e.g. `:label` to the label field.
+         * @tparam M The model type, described by SqlField descriptors.
+         * @param query The SQL query string.
+         * @param model The model providing the parameter values.
+         */
+        template<SqlSchemaModel M>
+        void executeQueryFromModel(const std::string &query, const M &model) {
+            if (!this->connectedFlag) {
+                throw SqlLiteServiceException("Connection is not open");
+            }
+
+            sqlite3_stmt *stmt = this->prepareStatement(query).stmt;
+            this->bindParameters(stmt, model);
+
+            if (const int rc = sqlite3_step(stmt); rc != SQLITE_DONE) {
+                std::cerr << "Error executing query: " << sqlite3_errmsg(this->db) << std::endl;
+                releaseStatement(stmt);
+                throw SqlLiteServiceException(sqlite3_errmsg(this->db));
+            }
+            releaseStatement(stmt);
+        }
+
+        /**
+         * @brief Starts an immediate transaction, acquiring the write lock up front so the
+         * transaction cannot fail halfway through because another writer got in first.
+         */
+        void beginTransaction() override;
+
+        /**
+         * @brief Commits the active transaction.
+         */
+        void commitTransaction() override;
+
+        /**
+         * @brief Rolls back the active transaction.
+         */
+        void rollbackTransaction() override;
+
+        /**
+         * @brief Returns how many queries reused an already prepared statement.
+         * @return The number of statement cache hits since the connection was opened.
+         */
+        [[nodiscard]] size_t getStatementCacheHits() const;
+
+        /**
+         * @brief Returns how many queries had to be prepared from scratch.
+         * @return The number of statement cache misses since the connection was opened.
+         */
+        [[nodiscard]] size_t getStatementCacheMisses() const;
+
         /**
          * @brief Constructs a SqlLiteService with an optional connection string.
          * @param connectionString The SQLite file path.
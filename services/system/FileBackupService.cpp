@@ -7,6 +7,7 @@
 #include <iostream>
 #include <algorithm>
 #include <filesystem>
+#include <optional>
 
 namespace DosboxStagingReplacer {
 
@@ -18,35 +19,40 @@ namespace DosboxStagingReplacer {
 
     FileEntity FileBackupService::createBackup(const std::string &filePath,
                                                const std::vector<FileEntity> &filesInPath) const {
-        auto filesInDirectory = filesInPath;
         FileEntity result;
-        // Check if filesInPath is empty
-        if (filesInDirectory.empty()) {
+        const auto isSourceFile = [&](const FileEntity &file) { return file.path == filePath; };
+        std::optional<FileEntity> sourceFile;
+        // Check if filesInPath is empty, if so the directory is only read until the file is found
+        if (filesInPath.empty()) {
             const std::string directoryPath = filePath.substr(0, filePath.find_last_of("\\/"));
-            filesInDirectory = DirectoryScanner::scanDirectory(directoryPath);
+            auto filesInDirectory = DirectoryScanner::entries(directoryPath);
+            if (const auto file = std::ranges::find_if(filesInDirectory, isSourceFile); file != filesInDirectory.end()) {
+                sourceFile = *file;
+            }
+        } else if (const auto file = std::ranges::find_if(filesInPath, isSourceFile); file != filesInPath.end()) {
+            sourceFile = *file;
         }
 
-        for (const auto &file: filesInDirectory) {
-            if (file.path == filePath) {
-                int backupCounter = 2;
-                std::string backupFilePath = file.path + backupFileExtension;
-                // Check if the backup file already exists, if so we increment the counter
-                // The file will be named file.bak, file.bak.2, file.bak.3, etc.
-                // Assuming the backup file extension is ".bak"
-                while (fileExists(backupFilePath)) {
-                    backupFilePath = file.path + backupFileExtension + std::to_string(backupCounter);
-                    backupCounter++;
-                }
-                // Copy the file to the backup file
-                try {
-                    copy_file(file.path, backupFilePath,
-                                               std::filesystem::copy_options::overwrite_existing);
-                    std::cout << "Backup created: " << backupFilePath << std::endl;
-                    result = file;
-                    result.path = backupFilePath;
-                } catch (const std::filesystem::filesystem_error &e) {
-                    std::cerr << "Error creating backup: " << e.what() << std::endl;
-                }
+        if (sourceFile.has_value()) {
+            const auto &file = sourceFile.value();
+            int backupCounter = 2;
+            std::string backupFilePath = file.path + backupFileExtension;
+            // Check if the backup file already exists, if so we increment the counter
+            // The file will be named file.bak, file.bak.2, file.bak.3, etc.
+            // Assuming the backup file extension is ".bak"
+            while (fileExists(backupFilePath)) {
+                backupFilePath = file.path + backupFileExtension + std::to_string(backupCounter);
+                backupCounter++;
+            }
+            // Copy the file to the backup file
+            try {
+                copy_file(file.path, backupFilePath,
+                                           std::filesystem::copy_options::overwrite_existing);
+                std::cout << "Backup created: " << backupFilePath << std::endl;
+                result = file;
+                result.path = backupFilePath;
+            } catch (const std::filesystem::filesystem_error &e) {
+                std::cerr << "Error creating backup: " << e.what() << std::endl;
             }
         }
         return result;
@@ -60,7 +66,8 @@ namespace DosboxStagingReplacer {
         // Check if filesInPath is empty
         if (filesInDirectory.empty()) {
             const std::string directoryPath = filePath.substr(0, filePath.find_last_of("\\/"));
-            filesInDirectory = DirectoryScanner::scanDirectory(directoryPath);
+            const std::string fileName = filePath.substr(filePath.find_last_of("\\/") + 1);
+            filesInDirectory = DirectoryScanner::scanDirectory(directoryPath, {.namePrefixes = {fileName}});
         }
 
         if (backupExists(filePath, filesInPath)) {
@@ -96,18 +103,23 @@ namespace DosboxStagingReplacer {
     }
 
     bool FileBackupService::backupExists(const std::string& filePath, const std::vector<FileEntity> &filesInPath) {
-        auto filesInDirectory = filesInPath;
-        // Check if filesInPath is empty
-        if (filesInDirectory.empty()) {
-            const std::string directoryPath = filePath.substr(0, filePath.find_last_of("\\/"));
-            filesInDirectory = DirectoryScanner::scanDirectory(directoryPath);
-        }
-
         // We check if the file exists in the directory, to do this we check if filePath is a substring of file.path
         // and if the length of file.path is greater than filePath, then we know that the file is a backup
         // This is also to cover other .bak files such as .bak.2, .bak.3, etc.
-        return std::ranges::any_of(filesInDirectory, [&](const auto& file) {
-            return file.path.find(filePath + this->backupFileExtension) != std::string::npos && file.path.length() > filePath.length();
-        });
+        const std::string backupPrefix = filePath + this->backupFileExtension;
+        const auto isBackup = [&](const FileEntity &file) {
+            return file.path.find(backupPrefix) != std::string::npos && file.path.length() > filePath.length();
+        };
+
+        // Check if filesInPath is empty, if so the directory is only read until a backup is found
+        if (filesInPath.empty()) {
+            const std::string directoryPath = filePath.substr(0, filePath.find_last_of("\\/"));
+            const std::string fileName = filePath.substr(filePath.find_last_of("\\/") + 1);
+            return std::ranges::any_of(
+                    DirectoryScanner::entries(directoryPath, {.readSizes = false,
+                                                              .namePrefixes = {fileName + this->backupFileExtension}}),
+                    isBackup);
+        }
+        return std::ranges::any_of(filesInPath, isBackup);
     }
 }
@@ -0,0 +1,49 @@
+#ifndef TEMPORARYDIRECTORY_H
+#define TEMPORARYDIRECTORY_H
+
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace DosboxStagingReplacer {
+
+    /**
+     * @brief A directory of its own under the temporary directory, removed with everything in it on destruction.
+     * The name is unique, so tests running at the same time never share one, and a test that fails half way does
+     * not leave its files behind.
+     */
+    class TemporaryDirectory {
+        std::filesystem::path path;
+
+    public:
+        explicit TemporaryDirectory(const std::string &prefix) {
+            std::random_device random;
+            std::uniform_int_distribution<unsigned long long> suffix;
+            const auto parent = std::filesystem::temp_directory_path();
+            // create_directory only returns true for a directory it created, not for one that already existed
+            for (int attempt = 0; attempt < 100; attempt++) {
+                auto candidate = parent / (prefix + "-" + std::to_string(suffix(random)));
+                if (std::filesystem::create_directory(candidate)) {
+                    this->path = std::move(candidate);
+                    return;
+                }
+            }
+            throw std::runtime_error("Could not create a temporary directory for " + prefix);
+        }
+
+        TemporaryDirectory(const TemporaryDirectory &) = delete;
+        TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+        ~TemporaryDirectory() {
+            std::error_code error;
+            std::filesystem::remove_all(this->path, error);
+        }
+
+        [[nodiscard]] const std::filesystem::path &getPath() const { return this->path; }
+    };
+
+} // namespace DosboxStagingReplacer
+
+#endif // TEMPORARYDIRECTORY_H
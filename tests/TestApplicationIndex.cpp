@@ -0,0 +1,61 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ApplicationIndex.h"
+#include "KeywordMatcher.h"
+
+namespace {
+    std::vector<std::string> namesOf(const std::vector<DosboxStagingReplacer::InstallationInfo> &applications) {
+        std::vector<std::string> names;
+        for (const auto &app: applications) {
+            names.push_back(app.applicationName);
+        }
+        return names;
+    }
+} // namespace
+
+int main() {
+    std::cout << "Testing KeywordMatcher" << std::endl;
+    const DosboxStagingReplacer::KeywordMatcher matcher("  Staging\tDOSBox ");
+    if (matcher.getKeywords() != std::vector<std::string>{"staging", "dosbox"} ||
+        !matcher.matches("io.github.dosbox-staging") || !matcher.matches("DOSBOX STAGING") ||
+        matcher.matches("dosbox-x") || !DosboxStagingReplacer::KeywordMatcher("").matches("anything")) {
+        std::cout << "KeywordMatcher did not match every keyword ignoring case" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing lazyStringMatching()" << std::endl;
+    // Upper case keywords used to be searched without being lowercased
+    if (!DosboxStagingReplacer::lazyStringMatching("dosbox-staging", {"DOSBox", "Staging"}) ||
+        DosboxStagingReplacer::lazyStringMatching("dosbox-staging", {"DOSBox", "ECE"})) {
+        std::cout << "lazyStringMatching() did not ignore the case of the keywords" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing ApplicationIndex::find()" << std::endl;
+    const DosboxStagingReplacer::ApplicationIndex index({{"dosbox", "/usr/bin/dosbox", "apt"},
+                                                         {"libc6", "", "apt"},
+                                                         {"io.github.dosbox-staging", "/var/lib/flatpak", "flatpak"},
+                                                         {"dosbox-x", "/usr/bin/dosbox-x", "apt"},
+                                                         {"sbox", "", "apt"},
+                                                         {"DOSBox-ECE", "/snap/bin/dosbox-ece", "snap"}});
+    if (namesOf(index.find("dosbox")) !=
+                std::vector<std::string>{"dosbox", "io.github.dosbox-staging", "dosbox-x", "DOSBox-ECE"} ||
+        namesOf(index.find("STAGING dosbox")) != std::vector<std::string>{"io.github.dosbox-staging"} ||
+        namesOf(index.find("ox-")) != std::vector<std::string>{"io.github.dosbox-staging", "dosbox-x", "DOSBox-ECE"} ||
+        namesOf(index.find("ox")) != std::vector<std::string>{"dosbox", "io.github.dosbox-staging", "dosbox-x", "sbox",
+                                                             "DOSBox-ECE"} ||
+        !index.find("scummvm").empty() || index.find("").size() != index.getApplications().size()) {
+        std::cout << "ApplicationIndex::find() did not return the applications matching every keyword" << std::endl;
+        return 1;
+    }
+    // Every trigram of the keyword is in the name, but not next to each other
+    const DosboxStagingReplacer::ApplicationIndex scattered({{"abcd-bcde", "", "apt"}});
+    if (!scattered.find("abcde").empty() || scattered.find("bcde").size() != 1) {
+        std::cout << "ApplicationIndex::find() returned a name holding the trigrams but not the keyword" << std::endl;
+        return 1;
+    }
+
+    std::cout << "ApplicationIndex tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "ApplicationInventory.h"
+#include "TemporaryDirectory.h"
+
+int main() {
+    const DosboxStagingReplacer::TemporaryDirectory temporary("TestApplicationInventory");
+    const auto &root = temporary.getPath();
+    const auto status = root / "status";
+    const auto cachePath = (root / "cache" / "installed-applications.cache").string();
+    std::ofstream(status) << "Package: dosbox";
+
+    std::vector<DosboxStagingReplacer::InstallationInfo> installed{{"dosbox", "/usr/bin/dosbox", "apt"},
+                                                                    {"libc6", "", "apt"}};
+    bool complete = true;
+    const auto lister = [&](bool &listComplete) {
+        listComplete = complete;
+        return installed;
+    };
+    // The missing database has no modification time, it is stamped all the same
+    const std::vector<std::string> databases{status.string(), (root / "rpmdb.sqlite").string()};
+
+    std::cout << "Testing ApplicationInventory in memory" << std::endl;
+    DosboxStagingReplacer::ApplicationInventory first(cachePath, databases, "/usr/bin", lister);
+    const auto listed = first.getApplications();
+    if (listed->size() != 2 || listed->front().installationPath != "/usr/bin/dosbox" ||
+        first.getApplications() != listed || first.getListCount() != 1) {
+        std::cout << "ApplicationInventory listed the applications again while nothing changed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing ApplicationInventory cache file" << std::endl;
+    installed.push_back({"scummvm", "/usr/games/scummvm", "apt"});
+    DosboxStagingReplacer::ApplicationInventory second(cachePath, databases, "/usr/bin", lister);
+    if (second.getApplications()->size() != 2 || second.getListCount() != 0) {
+        std::cout << "ApplicationInventory did not read the applications from the cache file" << std::endl;
+        return 1;
+    }
+    DosboxStagingReplacer::ApplicationInventory otherPath(cachePath, databases, "/usr/local/bin", lister);
+    if (otherPath.getApplications()->size() != 3 || otherPath.getListCount() != 1) {
+        std::cout << "ApplicationInventory used a cache file made with another context" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing ApplicationInventory invalidation" << std::endl;
+    std::filesystem::last_write_time(status, std::filesystem::last_write_time(status) + std::chrono::seconds(10));
+    if (second.getApplications()->size() != 3 || second.getListCount() != 1) {
+        std::cout << "ApplicationInventory did not list the applications again after a database changed" << std::endl;
+        return 1;
+    }
+    std::ofstream(root / "rpmdb.sqlite") << "SQLite format 3";
+    complete = false;
+    installed.pop_back();
+    if (second.getApplications()->size() != 2 || second.getListCount() != 2) {
+        std::cout << "ApplicationInventory did not list the applications again after a database appeared" << std::endl;
+        return 1;
+    }
+    // The incomplete list was kept by the process but not written, the next run lists again
+    DosboxStagingReplacer::ApplicationInventory third(cachePath, databases, "/usr/bin", lister);
+    third.getApplications();
+    if (third.getListCount() != 1) {
+        std::cout << "ApplicationInventory wrote an incomplete list to the cache file" << std::endl;
+        return 1;
+    }
+
+    std::cout << "ApplicationInventory tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <array>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include "CommandRunner.h"
+
+int main() {
+    std::cout << "Testing CommandRunner::splitFields()" << std::endl;
+    std::array<std::string_view, 2> fields;
+    if (DosboxStagingReplacer::CommandRunner::splitFields("dosbox\tx86_64\t0.82", fields) != 2 ||
+        fields[0] != "dosbox" || fields[1] != "x86_64\t0.82" ||
+        DosboxStagingReplacer::CommandRunner::splitFields("gpg-pubkey", fields) != 1 || fields[0] != "gpg-pubkey") {
+        std::cout << "CommandRunner::splitFields() did not split the record" << std::endl;
+        return 1;
+    }
+
+#ifndef _WIN32
+    using namespace std::chrono_literals;
+    std::cout << "Testing CommandRunner::run()" << std::endl;
+    std::vector<std::string> lines;
+    const auto collect = [&](const std::string_view line) { lines.emplace_back(line); };
+    // A read size smaller than a line makes the buffer grow
+    const std::string longLine(1000, 'x');
+    auto result = DosboxStagingReplacer::CommandRunner::run(
+            {"sh", "-c", "printf 'dosbox\\tx86_64\\n\\n%s\\nlast' " + longLine + "; exit 3"}, collect,
+            {.readSize = 16});
+    if (lines != std::vector<std::string>{"dosbox\tx86_64", "", longLine, "last"} || result.exitCode != 3 ||
+        result.succeeded()) {
+        std::cout << "CommandRunner::run() did not return every line and the exit code" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing CommandRunner::run() timeout" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    result = DosboxStagingReplacer::CommandRunner::run({"sleep", "10"}, collect, {.timeout = 100ms});
+    if (!result.timedOut || std::chrono::steady_clock::now() - start > 5s) {
+        std::cout << "CommandRunner::run() did not kill the command once it timed out" << std::endl;
+        return 1;
+    }
+
+    // Closes its output long before it exits
+    start = std::chrono::steady_clock::now();
+    result = DosboxStagingReplacer::CommandRunner::run({"sh", "-c", "exec >&-; sleep 10"}, collect, {.timeout = 100ms});
+    if (!result.timedOut || std::chrono::steady_clock::now() - start > 5s) {
+        std::cout << "CommandRunner::run() waited for a command without output past the timeout" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing CommandRunner::run() stop" << std::endl;
+    std::stop_source stop;
+    std::jthread stopper([&] {
+        std::this_thread::sleep_for(100ms);
+        stop.request_stop();
+    });
+    start = std::chrono::steady_clock::now();
+    result = DosboxStagingReplacer::CommandRunner::run({"sleep", "10"}, collect, {.stop = stop.get_token()});
+    if (!result.stopped || std::chrono::steady_clock::now() - start > 5s) {
+        std::cout << "CommandRunner::run() did not kill the command once a stop was requested" << std::endl;
+        return 1;
+    }
+
+    try {
+        DosboxStagingReplacer::CommandRunner::run({"DosboxStagingReplacer-missing-command"}, collect);
+        std::cout << "CommandRunner::run() did not report a command that cannot be started" << std::endl;
+        return 1;
+    } catch (const std::runtime_error &) {
+    }
+
+#endif
+
+    std::cout << "CommandRunner tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "DataExporter.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+int main() {
+    std::cout << "Testing OutputSink" << std::endl;
+    DosboxStagingReplacer::MemorySink memory;
+    memory << "size=" << 4096ul << ',' << -1 << std::string(",") << std::string_view("end");
+    if (memory.getContents() != "size=4096,-1,end" || memory.takeContents() != "size=4096,-1,end" ||
+        !memory.getContents().empty()) {
+        std::cout << "MemorySink did not collect what was written" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing FileDescriptorSink" << std::endl;
+    const auto outputPath = std::filesystem::temp_directory_path() / "TestDataExporter.txt";
+    const std::string longText(100, 'x');
+    {
+#ifdef _WIN32
+        const int fd = _open(outputPath.string().c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        const int fd = open(outputPath.string().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+        // A buffer smaller than some of the writes, so both paths are taken
+        DosboxStagingReplacer::FileDescriptorSink sink(fd, 16);
+        for (int i = 0; i < 10; ++i) {
+            sink << "row " << i << '\n';
+        }
+        sink << longText;
+        sink.flush();
+#ifdef _WIN32
+        _close(fd);
+#else
+        close(fd);
+#endif
+    }
+    std::stringstream written;
+    written << std::ifstream(outputPath).rdbuf();
+    std::string expected;
+    for (int i = 0; i < 10; ++i) {
+        expected += "row " + std::to_string(i) + "\n";
+    }
+    if (written.str() != expected + longText) {
+        std::cout << "FileDescriptorSink did not write everything in order" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing AtomicFileSink" << std::endl;
+    const auto readFile = [](const std::filesystem::path &path) {
+        std::stringstream contents;
+        contents << std::ifstream(path).rdbuf();
+        return contents.str();
+    };
+    // Temporary files are named after the target, none may be left once a sink is gone
+    const auto leftTemporaryFile = [&] {
+        const auto prefix = outputPath.filename().string() + ".";
+        const std::filesystem::directory_iterator files(outputPath.parent_path());
+        return std::ranges::any_of(files, [&](const auto &file) {
+            const auto name = file.path().filename().string();
+            return name.starts_with(prefix) && name != prefix + "tmp";
+        });
+    };
+    std::ofstream(outputPath) << "previous export";
+    // An unrelated file that used to be taken as the temporary file
+    std::ofstream(outputPath.string() + ".tmp") << "unrelated";
+    {
+        DosboxStagingReplacer::AtomicFileSink sink(outputPath.string(), 16);
+        sink << expected;
+        // Interrupted before finish, e.g. by an exception
+    }
+    if (readFile(outputPath) != "previous export" || leftTemporaryFile()) {
+        std::cout << "AtomicFileSink modified the target or left its temporary file without finish()" << std::endl;
+        return 1;
+    }
+#ifndef _WIN32
+    constexpr auto targetPermissions = std::filesystem::perms::owner_read | std::filesystem::perms::owner_write |
+                                       std::filesystem::perms::group_read;
+    std::filesystem::permissions(outputPath, targetPermissions);
+#endif
+    {
+        DosboxStagingReplacer::AtomicFileSink sink(outputPath.string(), 16);
+        // A second export of the same target at the same time
+        DosboxStagingReplacer::AtomicFileSink concurrent(outputPath.string(), 16);
+        concurrent << "concurrent export";
+        sink << expected << longText;
+        if (readFile(outputPath) != "previous export") {
+            std::cout << "AtomicFileSink modified the target before finish()" << std::endl;
+            return 1;
+        }
+        sink.finish();
+        sink.finish();
+    }
+    if (readFile(outputPath) != expected + longText || leftTemporaryFile() ||
+        readFile(outputPath.string() + ".tmp") != "unrelated") {
+        std::cout << "AtomicFileSink did not replace the target on finish()" << std::endl;
+        return 1;
+    }
+#ifndef _WIN32
+    if (std::filesystem::status(outputPath).permissions() != targetPermissions) {
+        std::cout << "AtomicFileSink did not keep the permissions of the target" << std::endl;
+        return 1;
+    }
+#endif
+    std::filesystem::remove(outputPath);
+    std::filesystem::remove(outputPath.string() + ".tmp");
+    try {
+        DosboxStagingReplacer::AtomicFileSink sink((outputPath / "missing" / "export.json").string());
+        std::cout << "AtomicFileSink did not report a file that cannot be created" << std::endl;
+        return 1;
+    } catch (const std::runtime_error &) {
+    }
+
+    std::cout << "Testing DataExporter formats" << std::endl;
+    const std::vector<DosboxStagingReplacer::InstallationInfo> applications{{"dosbox", "/usr/bin/dosbox", "apt"},
+                                                                            {"say \"hi\"", "C:\\Games", "registry"}};
+    const std::vector<DosboxStagingReplacer::FileEntity> files{
+            DosboxStagingReplacer::FileEntity("galaxy-2.0.db", "/storage/galaxy-2.0.db",
+                                              DosboxStagingReplacer::FileType::FILE, 1024)};
+    auto user = std::make_shared<DosboxStagingReplacer::GogUser>();
+    user->id = 42;
+    const std::vector<std::shared_ptr<DosboxStagingReplacer::SqlDataResult>> users{user, user};
+
+    const auto json = DosboxStagingReplacer::DataExporterFactory::createDataExporter(".json");
+    if (json->serialize(applications) !=
+                R"([{"applicationName": "dosbox", "installationPath": "/usr/bin/dosbox", "source": "apt"},)"
+                R"({"applicationName": "say \"hi\"", "installationPath": "C:\\Games", "source": "registry"}])" ||
+        json->serialize(files) !=
+                R"([{"name": "galaxy-2.0.db", "path": "/storage/galaxy-2.0.db", "type": "File", "size": 1024}])" ||
+        json->serialize(users) != R"([{"id": 42},{"id": 42}])" ||
+        json->serialize(std::vector<DosboxStagingReplacer::FileEntity>{}) != "[]") {
+        std::cout << "JSONDataExporter did not write the expected JSON" << std::endl;
+        return 1;
+    }
+    const auto csv = DosboxStagingReplacer::DataExporterFactory::createDataExporter(".csv");
+    if (csv->serialize(applications) != "dosbox,/usr/bin/dosbox,apt\nsay \"hi\",C:\\Games,registry\n" ||
+        csv->serialize(files) != "galaxy-2.0.db,/storage/galaxy-2.0.db,File,1024\n" ||
+        csv->serialize(users) != "42,\n42,\n") {
+        std::cout << "CSVDataExporter did not write the expected CSV" << std::endl;
+        return 1;
+    }
+    const auto text = DosboxStagingReplacer::DataExporterFactory::createDataExporter(".txt");
+    if (text->stringify(applications[0]) != "applicationName=dosbox,installationPath=/usr/bin/dosbox,source=apt" ||
+        text->serialize(users) != "id=42,\nid=42,\n") {
+        std::cout << "DataExporter did not write the expected name=value pairs" << std::endl;
+        return 1;
+    }
+
+    std::cout << "DataExporter tests passed" << std::endl;
+    return 0;
+}
@@ -1,7 +1,123 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include "DirectoryScanner.h"
+#include "TemporaryDirectory.h"
 
 int main () {
+    std::cout << "Testing DirectoryScanner::containsEntry()" << std::endl;
+    size_t visitedEntries = 0;
+    const bool containsValid = DosboxStagingReplacer::DirectoryScanner::containsEntry("../tests/data", [&](const std::string_view name) {
+        visitedEntries++;
+        return name == "valid.sqlite";
+    });
+    const bool containsMissing = DosboxStagingReplacer::DirectoryScanner::containsEntry("../tests/data", [](const std::string_view name) {
+        return name == "missing.sqlite";
+    });
+    if (!containsValid || containsMissing || visitedEntries > 3) {
+        std::cout << "DirectoryScanner::containsEntry() did not match the expected entries" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing DirectoryScanner backends return the same entries" << std::endl;
+    auto portableFiles = DosboxStagingReplacer::DirectoryScanner::scanDirectory(
+            "../tests/data", {.backend = DosboxStagingReplacer::ScanBackend::Portable});
+    auto getdentsFiles = DosboxStagingReplacer::DirectoryScanner::scanDirectory(
+            "../tests/data", {.backend = DosboxStagingReplacer::ScanBackend::Getdents});
+    const auto byName = [](const auto &left, const auto &right) { return left.name < right.name; };
+    std::ranges::sort(portableFiles, byName);
+    std::ranges::sort(getdentsFiles, byName);
+    if (!std::ranges::equal(portableFiles, getdentsFiles, [](const auto &left, const auto &right) {
+            return left.name == right.name && left.path == right.path && left.type == right.type &&
+                   left.size == right.size;
+        })) {
+        std::cout << "DirectoryScanner backends returned different entries" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing DirectoryScanner::entries()" << std::endl;
+    static_assert(std::ranges::input_range<DosboxStagingReplacer::DirectoryRange>);
+    size_t lazyEntries = 0;
+    for (const auto &file: DosboxStagingReplacer::DirectoryScanner::entries("../tests/data")) {
+        lazyEntries += file.name.empty() ? 0 : 1;
+    }
+    if (lazyEntries != portableFiles.size() ||
+        !std::ranges::any_of(DosboxStagingReplacer::DirectoryScanner::entries("../tests/data"),
+                             [](const auto &file) { return file.name == "folder" && file.isDirectory(); })) {
+        std::cout << "DirectoryScanner::entries() did not yield the directory entries" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing DirectoryScanner filters" << std::endl;
+    if (!DosboxStagingReplacer::DirectoryScanner::matchesGlob("*.sqlite", "valid.sqlite") ||
+        !DosboxStagingReplacer::DirectoryScanner::matchesGlob("galaxy-2.0.db.bak*", "galaxy-2.0.db.bak.2") ||
+        !DosboxStagingReplacer::DirectoryScanner::matchesGlob("DOSBOX.EXE", "dosbox.exe", true) ||
+        !DosboxStagingReplacer::DirectoryScanner::matchesGlob("?a*a*", "banana") ||
+        DosboxStagingReplacer::DirectoryScanner::matchesGlob("DOSBOX.EXE", "dosbox.exe") ||
+        DosboxStagingReplacer::DirectoryScanner::matchesGlob("*.sqlite", "valid.sqlite-journal")) {
+        std::cout << "DirectoryScanner::matchesGlob() did not match the expected names" << std::endl;
+        return 1;
+    }
+    const auto scannedNames = [](const DosboxStagingReplacer::ScanOptions &options) {
+        std::vector<std::string> scanned;
+        for (const auto &file: DosboxStagingReplacer::DirectoryScanner::scanDirectory("../tests/data", options)) {
+            scanned.push_back(file.name);
+        }
+        std::ranges::sort(scanned);
+        return scanned;
+    };
+    for (const auto backend: {DosboxStagingReplacer::ScanBackend::Portable, DosboxStagingReplacer::ScanBackend::Getdents}) {
+        if (scannedNames({.backend = backend, .nameGlobs = {"*.SQLITE"}, .globsIgnoreCase = true}) !=
+                    std::vector<std::string>{"invalid.sqlite", "valid.sqlite"} ||
+            scannedNames({.backend = backend, .namePrefixes = {"valid", "fold"}}) !=
+                    std::vector<std::string>{"folder", "valid.sqlite"} ||
+            // Prefixes are not globs, a name has to start with the * itself
+            !scannedNames({.backend = backend, .namePrefixes = {"*"}}).empty() ||
+            scannedNames({.backend = backend, .suffixes = {".SQLite"}, .minSize = 1}) !=
+                    std::vector<std::string>{"valid.sqlite"} ||
+            scannedNames({.backend = backend, .maxSize = 0}) != std::vector<std::string>{"folder", "invalid.sqlite"} ||
+            scannedNames({.backend = backend, .type = DosboxStagingReplacer::FileType::DIRECTORY}) !=
+                    std::vector<std::string>{"folder"}) {
+            std::cout << "DirectoryScanner filters did not return the expected entries" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Testing DirectoryScanner::scanRecursive()" << std::endl;
+    const DosboxStagingReplacer::TemporaryDirectory temporary("TestDirectoryScanner");
+    const auto &tree = temporary.getPath();
+    std::filesystem::create_directories(tree / "game" / "DOSBOX");
+    std::filesystem::create_directories(tree / "extras");
+    std::ofstream(tree / "game" / "DOSBOX" / "dosbox.exe");
+    std::ofstream(tree / "game" / "dosbox.conf");
+    std::filesystem::create_directory_symlink(tree, tree / "game" / "loop");
+
+    const auto names = [&](const std::vector<DosboxStagingReplacer::FileEntity> &entries) {
+        std::vector<std::string> relativePaths;
+        for (const auto &entry: entries) {
+            relativePaths.push_back(std::filesystem::path(entry.path).lexically_relative(tree).generic_string());
+        }
+        return relativePaths;
+    };
+    const std::vector<std::string> expectedTree = {"extras", "game", "game/DOSBOX", "game/DOSBOX/dosbox.exe",
+                                                   "game/dosbox.conf", "game/loop"};
+    const std::vector<std::string> expectedConfigs = {"game/dosbox.conf"};
+    const std::vector<std::string> expectedShallow = {"extras", "game"};
+    if (names(DosboxStagingReplacer::DirectoryScanner::scanRecursive(tree.string(), {.jobs = 4})) != expectedTree ||
+        names(DosboxStagingReplacer::DirectoryScanner::scanRecursive(
+                tree.string(), {.predicate = [](const auto &file) { return file.name.ends_with(".conf"); }})) !=
+                expectedConfigs ||
+        names(DosboxStagingReplacer::DirectoryScanner::scanRecursive(tree.string(), {.scan = {.suffixes = {".conf"}}})) !=
+                expectedConfigs ||
+        names(DosboxStagingReplacer::DirectoryScanner::scanRecursive(tree.string(), {.maxDepth = 0})) !=
+                expectedShallow ||
+        names(DosboxStagingReplacer::DirectoryScanner::scanRecursive(
+                tree.string(), {.symlinks = DosboxStagingReplacer::SymlinkPolicy::Follow})) != expectedTree) {
+        std::cout << "DirectoryScanner::scanRecursive() did not return the expected entries" << std::endl;
+        return 1;
+    }
+
     const auto files = DosboxStagingReplacer::DirectoryScanner::scanDirectory("../tests/data");
     // Check if in the files there is an entry called invalid.sqlite and folder, invalid.sqlite must be a file
     // while folder must be a directory
@@ -0,0 +1,60 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "DosClassificationCache.h"
+#include "TemporaryDirectory.h"
+
+int main() {
+    const DosboxStagingReplacer::TemporaryDirectory temporary("TestDosClassificationCache");
+    const auto &root = temporary.getPath();
+    std::filesystem::create_directories(root / "game" / "DOSBOX");
+    std::ofstream(root / "game" / "dosboxGame.conf") << "[sdl]" << std::endl;
+    const auto cachePath = (root / "cache.sqlite").string();
+
+    DosboxStagingReplacer::DosClassification current;
+    current.installationPath = (root / "game").string();
+
+    std::cout << "Testing DosClassificationCache::classify()" << std::endl;
+    if (!DosboxStagingReplacer::DosClassificationCache::readDirectoryStamp(current)) {
+        std::cout << "DosClassificationCache::readDirectoryStamp() could not read the game directory" << std::endl;
+        return 1;
+    }
+    DosboxStagingReplacer::DosClassificationCache::classify(current);
+    if (!current.isDos || current.dosboxPath != (root / "game" / "DOSBOX").string() ||
+        current.configFiles != (root / "game" / "dosboxGame.conf").string()) {
+        std::cout << "DosClassificationCache::classify() did not detect the DOSBox folder and config file" << std::endl;
+        return 1;
+    }
+    std::cout << "DosClassificationCache::classify() passed" << std::endl;
+
+    std::cout << "Testing DosClassificationCache persistence" << std::endl;
+    {
+        DosboxStagingReplacer::DosClassificationCache cache(cachePath);
+        if (cache.find(current) != nullptr) {
+            std::cout << "DosClassificationCache::find() returned an entry from an empty cache" << std::endl;
+            return 1;
+        }
+        cache.store({current});
+    }
+    {
+        // A new instance has to see the stored entry as long as the directory is unchanged
+        DosboxStagingReplacer::DosClassificationCache cache(cachePath);
+        const auto *cached = cache.find(current);
+        if (cache.size() != 1 || cached == nullptr || !cached->isDos || cached->configFiles != current.configFiles) {
+            std::cout << "DosClassificationCache did not persist the stored entry" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Testing DosClassificationCache invalidation" << std::endl;
+        std::filesystem::remove_all(root / "game" / "DOSBOX");
+        DosboxStagingReplacer::DosClassification changed;
+        changed.installationPath = current.installationPath;
+        DosboxStagingReplacer::DosClassificationCache::readDirectoryStamp(changed);
+        if (cache.find(changed) != nullptr) {
+            std::cout << "DosClassificationCache::find() returned an entry for a changed directory" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "DosClassificationCache passed" << std::endl;
+    return 0;
+}
@@ -1,6 +1,11 @@
 #include <StatementParser.h>
+#include <filesystem>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include "GogGalaxyService.h"
+#include "TemporaryDirectory.h"
 
 int main() {
     std::cout << "Testing GogGalaxyService::openConnection() with valid GOG Galaxy database" << std::endl;
@@ -48,5 +53,104 @@ int main() {
         std::cout << "GogGalaxyService::getPlayTaskTypes() failed as expected: " << e.what() << std::endl;
     }
 
+    // Batch tests write to the database, so they run against a copy of the valid database
+    const DosboxStagingReplacer::TemporaryDirectory temporary("TestGogGalaxyService");
+    const auto batchDatabase = temporary.getPath() / "batch.sqlite";
+    std::filesystem::copy_file("../tests/data/valid.sqlite", batchDatabase,
+                               std::filesystem::copy_options::overwrite_existing);
+    {
+        DosboxStagingReplacer::SqlLiteService seedService(batchDatabase.string());
+        seedService.executeQuery("INSERT INTO PlayTaskTypes (id, type) VALUES (1, 'Custom');", {});
+    }
+
+    DosboxStagingReplacer::GogGalaxyService batchService(batchDatabase.string());
+    DosboxStagingReplacer::PlayTaskInformation playTask;
+    playTask.gameReleaseKey = "gog_1";
+    playTask.typeId = 1;
+    playTask.isPrimary = true;
+    DosboxStagingReplacer::PlayTaskLaunchParameters launchParameters;
+    launchParameters.executablePath = "dosbox.exe";
+    launchParameters.commandLineArgs = "-conf dosbox.conf";
+    launchParameters.label = "DOSBox";
+
+    std::cout << "Testing GogGalaxyService::executeBatch() rolls back on failure" << std::endl;
+    try {
+        batchService.executeBatch([&] {
+            batchService.addPlayTask(1, "gog_1", playTask, launchParameters);
+            throw std::runtime_error("Simulated failure");
+        });
+        std::cout << "GogGalaxyService::executeBatch() should rethrow the failure" << std::endl;
+        return 1;
+    } catch (const std::runtime_error &e) {
+        std::cout << "GogGalaxyService::executeBatch() failed as expected: " << e.what() << std::endl;
+    }
+    if (!batchService.getPlayTasks().empty()) {
+        std::cout << "GogGalaxyService::executeBatch() did not roll back the inserted play task" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing GogGalaxyService::executeBatch() commits all operations" << std::endl;
+    batchService.executeBatch([&] {
+        batchService.addPlayTask(1, "gog_1", playTask, launchParameters);
+        batchService.addPlayTask(2, "gog_1", playTask, launchParameters);
+    });
+    if (const auto batchTasks = batchService.getPlayTasks(); batchTasks.size() != 2) {
+        std::cout << "GogGalaxyService::executeBatch() committed " << batchTasks.size() << " play tasks instead of 2"
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "GogGalaxyService::executeBatch() passed" << std::endl;
+
+    std::cout << "Testing GogGalaxyService::getPlayTaskViewsFromGameReleaseKey()" << std::endl;
+    const auto playTaskViews = batchService.getPlayTaskViewsFromGameReleaseKey("gog_1");
+    if (playTaskViews.size() != 2 || playTaskViews[0].gameReleaseKey != "gog_1" || playTaskViews[1].type != "Custom") {
+        std::cout << "GogGalaxyService::getPlayTaskViewsFromGameReleaseKey() did not return the committed play tasks"
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "GogGalaxyService::getPlayTaskViewsFromGameReleaseKey() passed" << std::endl;
+
+    // Every other product ships a DOSBOX folder
+    std::cout << "Testing GogGalaxyService::getProducts() with parallel DOS classification" << std::endl;
+    const auto gamesRoot = temporary.getPath() / "games";
+    std::vector<std::string> expectedDosPaths;
+    for (int productId = 1; productId <= 8; ++productId) {
+        const auto installationPath = gamesRoot / ("game" + std::to_string(productId));
+        std::filesystem::create_directories(installationPath);
+        if (productId % 2 == 0) {
+            std::filesystem::create_directories(installationPath / "DOSBOX");
+        }
+        const std::string releaseKey = "gog_" + std::to_string(productId);
+        const std::string path = installationPath.string();
+        DosboxStagingReplacer::SqlLiteService seedService(batchDatabase.string());
+        seedService.executeQuery("INSERT INTO LimitedDetails (productId, languageId, is_production, stored_at, title) "
+                                 "VALUES (:productId, 1, 1, 0, :title);",
+                                 {productId, std::string_view(releaseKey)});
+        seedService.executeQuery("INSERT INTO ProductsToReleaseKeys (gogId, releaseKey) VALUES (:gogId, :releaseKey);",
+                                 {productId, std::string_view(releaseKey)});
+        seedService.executeQuery("INSERT INTO InstalledBaseProducts (productId, generation, languageId, "
+                                 "installationPath, installationId) "
+                                 "VALUES (:productId, 2, 1, :installationPath, :installationId);",
+                                 {productId, std::string_view(path), productId});
+    }
+    // The products without the filter give the query order the filtered products have to keep
+    for (const auto &product: batchService.getProducts({}, false)) {
+        if (std::filesystem::exists(std::filesystem::path(product.installationPath) / "DOSBOX")) {
+            expectedDosPaths.push_back(product.installationPath);
+        }
+    }
+    batchService.setScanJobs(4);
+    std::vector<std::string> dosPaths;
+    for (const auto &product: batchService.getProducts({}, true)) {
+        dosPaths.push_back(product.installationPath);
+    }
+    if (expectedDosPaths.size() != 4 || dosPaths != expectedDosPaths) {
+        std::cout << "GogGalaxyService::getProducts() did not keep exactly the DOS games in query order" << std::endl;
+        return 1;
+    }
+    std::cout << "GogGalaxyService::getProducts() with parallel DOS classification passed" << std::endl;
+
+    batchService.closeConnection();
+
     return 0;
 }
@@ -0,0 +1,214 @@
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include "InstallationFinder.h"
+#include "TemporaryDirectory.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+int main() {
+    std::cout << "Testing readDpkgInstalledPackages()" << std::endl;
+    const auto packages = DosboxStagingReplacer::readDpkgInstalledPackages("../tests/fixtures/dpkg/status");
+    if (packages != std::vector<std::string>{"coreutils", "dosbox", "libc6"} ||
+        !DosboxStagingReplacer::readDpkgInstalledPackages("../tests/fixtures/dpkg/missing").empty()) {
+        std::cout << "readDpkgInstalledPackages() did not return the installed packages of the fixture" << std::endl;
+        return 1;
+    }
+
+    const DosboxStagingReplacer::TemporaryDirectory temporary("TestInstallationFinder");
+    const auto &root = temporary.getPath();
+
+    std::cout << "Testing ExecutableIndex" << std::endl;
+    std::filesystem::create_directories(root / "bin");
+    std::filesystem::create_directories(root / "local");
+    std::ofstream(root / "bin" / "dosbox") << "#!/bin/sh";
+    std::ofstream(root / "bin" / "readme") << "not executable";
+    std::ofstream(root / "local" / "dosbox") << "#!/bin/sh";
+    std::filesystem::permissions(root / "bin" / "dosbox", std::filesystem::perms::owner_exec,
+                                 std::filesystem::perm_options::add);
+    std::filesystem::permissions(root / "local" / "dosbox", std::filesystem::perms::owner_exec,
+                                 std::filesystem::perm_options::add);
+#ifdef _WIN32
+    const auto searchPath = (root / "bin").string() + ";;" + (root / "local").string();
+#else
+    const auto searchPath = (root / "bin").string() + "::" + (root / "missing").string() + ":" + (root / "local").string();
+#endif
+    if (DosboxStagingReplacer::ExecutableIndex::splitSearchPath(searchPath) !=
+#ifdef _WIN32
+        std::vector<std::string>{(root / "bin").string(), (root / "local").string()}) {
+#else
+        std::vector<std::string>{(root / "bin").string(), (root / "missing").string(), (root / "local").string()}) {
+#endif
+        std::cout << "ExecutableIndex::splitSearchPath() did not return the directories in order" << std::endl;
+        return 1;
+    }
+    const DosboxStagingReplacer::ExecutableIndex executables(searchPath);
+    if (executables.find("dosbox") != (root / "bin" / "dosbox").string() || executables.contains("scummvm")) {
+        std::cout << "ExecutableIndex did not resolve commands in search path order" << std::endl;
+        return 1;
+    }
+#ifndef _WIN32
+    if (executables.contains("readme")) {
+        std::cout << "ExecutableIndex indexed a file that is not executable" << std::endl;
+        return 1;
+    }
+#endif
+
+    if (&DosboxStagingReplacer::ExecutableIndex::system() != &DosboxStagingReplacer::ExecutableIndex::system()) {
+        std::cout << "ExecutableIndex::system() built the index more than once" << std::endl;
+        return 1;
+    }
+#ifdef __linux__
+    if (DosboxStagingReplacer::ExecutableIndex::system().find("sh").empty()) {
+        std::cout << "ExecutableIndex::system() did not find sh in the PATH" << std::endl;
+        return 1;
+    }
+#endif
+
+    std::cout << "Testing resolvePackageExecutables()" << std::endl;
+    const auto resolved = DosboxStagingReplacer::resolvePackageExecutables(packages, "dpkg", executables);
+    if (resolved.size() != 3 || resolved[1].installationPath != (root / "bin" / "dosbox").string() ||
+        !resolved[2].installationPath.empty() || resolved[0].source != "dpkg") {
+        std::cout << "resolvePackageExecutables() did not resolve the package commands" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing readFlatpakApplications()" << std::endl;
+    const auto flatpak = root / "flatpak";
+    const auto deployment = flatpak / "app" / "io.github.dosbox-staging" / "x86_64" / "stable" / "0123abcd";
+    std::filesystem::create_directories(deployment);
+    std::filesystem::create_directory_symlink("x86_64/stable", flatpak / "app" / "io.github.dosbox-staging" / "current");
+    std::filesystem::create_directory_symlink("0123abcd", deployment.parent_path() / "active");
+    // Left over from an uninstalled application, it has no current deployment
+    std::filesystem::create_directories(flatpak / "app" / "org.scummvm.ScummVM");
+    const auto applications = DosboxStagingReplacer::readFlatpakApplications(flatpak.string());
+    if (applications.size() != 1 || applications[0].applicationName != "io.github.dosbox-staging" ||
+        applications[0].installationPath != std::filesystem::canonical(deployment).string() ||
+        applications[0].source != "flatpak") {
+        std::cout << "readFlatpakApplications() did not return the deployed applications" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing readSnapApplications()" << std::endl;
+    std::filesystem::create_directories(root / "snap" / "bin");
+    std::filesystem::create_directories(root / "snap" / "dosbox" / "12");
+    std::filesystem::create_directory_symlink("12", root / "snap" / "dosbox" / "current");
+    const auto snaps = DosboxStagingReplacer::readSnapApplications((root / "snap").string(), executables);
+    if (snaps.size() != 1 || snaps[0].applicationName != "dosbox" || snaps[0].source != "snap" ||
+        snaps[0].installationPath != (root / "bin" / "dosbox").string()) {
+        std::cout << "readSnapApplications() did not return the installed snaps" << std::endl;
+        return 1;
+    }
+    std::stop_source stopped;
+    stopped.request_stop();
+    if (!DosboxStagingReplacer::readFlatpakApplications(flatpak.string(), stopped.get_token()).empty() ||
+        !DosboxStagingReplacer::readSnapApplications((root / "snap").string(), executables, stopped.get_token())
+                 .empty()) {
+        std::cout << "readFlatpakApplications() or readSnapApplications() did not return early on a stop" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing queryPackageSources()" << std::endl;
+    using namespace std::chrono_literals;
+    std::atomic<bool> cancelled = false;
+    // Finishes within the timeout of the query, but not within its own
+    std::atomic<bool> impatientCancelled = false;
+    const auto waitForStop = [](const std::stop_token &stop, const int steps) {
+        for (int i = 0; i < steps && !stop.stop_requested(); i++) {
+            std::this_thread::sleep_for(10ms);
+        }
+        return stop.stop_requested();
+    };
+    const std::vector<DosboxStagingReplacer::PackageSource> sources{
+        {"slow", [&](const std::stop_token &stop) {
+            cancelled = waitForStop(stop, 500);
+            return std::vector<DosboxStagingReplacer::InstallationInfo>{{"slow", "", "slow"}};
+        }},
+        {"broken", [](std::stop_token) -> std::vector<DosboxStagingReplacer::InstallationInfo> {
+            throw std::runtime_error("database is locked");
+        }},
+        {"impatient", [&](const std::stop_token &stop) {
+            impatientCancelled = waitForStop(stop, 10);
+            return std::vector<DosboxStagingReplacer::InstallationInfo>{{"impatient", "", "impatient"}};
+        }, 30ms},
+        {"odd", [](std::stop_token) -> std::vector<DosboxStagingReplacer::InstallationInfo> {
+            throw 42;
+        }},
+        {"dpkg", [&](std::stop_token) {
+            std::this_thread::sleep_for(20ms);
+            auto applications = resolved;
+            applications.push_back(resolved[1]);
+            return applications;
+        }},
+        {"snap", [&](std::stop_token) { return snaps; }},
+    };
+    std::vector<DosboxStagingReplacer::PackageSourceReport> reports;
+    const auto start = std::chrono::steady_clock::now();
+    const auto merged = DosboxStagingReplacer::queryPackageSources(sources, 300ms, &reports);
+    if (std::chrono::steady_clock::now() - start > 2s) {
+        std::cout << "queryPackageSources() waited for a source past the timeout" << std::endl;
+        return 1;
+    }
+    if (merged.size() != 4 || merged[0].applicationName != "coreutils" || merged[2].applicationName != "libc6" ||
+        merged[3].source != "snap") {
+        std::cout << "queryPackageSources() did not merge the sources in order without duplicates" << std::endl;
+        return 1;
+    }
+    if (reports.size() != 6 || !reports[0].timedOut || !reports[1].failed || !reports[2].timedOut ||
+        reports[2].duration != 30ms || !reports[3].failed || reports[4].applicationCount != 3 ||
+        reports[4].duration < 20ms || reports[5].timedOut || reports[5].failed) {
+        std::cout << "queryPackageSources() did not report how every source did" << std::endl;
+        return 1;
+    }
+    // The source threads are joined before the query returns
+    if (!cancelled || !impatientCancelled) {
+        std::cout << "queryPackageSources() did not ask the timed out sources to stop" << std::endl;
+        return 1;
+    }
+
+#ifndef _WIN32
+    std::cout << "Testing queryPackageSources() with a reader that never reaches the end" << std::endl;
+    // A status file that never ends, only a reader that honours the stop request returns
+    const auto endlessStatus = root / "status";
+    if (mkfifo(endlessStatus.c_str(), 0600) != 0) {
+        std::cout << "Could not create the endless status file" << std::endl;
+        return 1;
+    }
+    // The writer finds out the reader is gone through EPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+    std::thread writer([&] {
+        const int fd = open(endlessStatus.c_str(), O_WRONLY);
+        constexpr std::string_view stanza = "Package: dosbox\nStatus: install ok installed\n\n";
+        while (fd >= 0 && write(fd, stanza.data(), stanza.size()) > 0) {
+        }
+        close(fd);
+    });
+    std::vector<DosboxStagingReplacer::InstallationInfo> dpkgApplications{{"unset", "", "dpkg"}};
+    const std::vector<DosboxStagingReplacer::PackageSource> endless{
+        {"dpkg", [&](const std::stop_token &stop) {
+            dpkgApplications = DosboxStagingReplacer::resolvePackageExecutables(
+                    DosboxStagingReplacer::readDpkgInstalledPackages(endlessStatus.string(), stop), "dpkg", executables);
+            return dpkgApplications;
+        }},
+    };
+    const auto endlessMerged = DosboxStagingReplacer::queryPackageSources(endless, 50ms, &reports);
+    writer.join();
+    if (!endlessMerged.empty() || reports.size() != 1 || !reports[0].timedOut || !dpkgApplications.empty()) {
+        std::cout << "readDpkgInstalledPackages() did not stop reading once queryPackageSources() gave up on it"
+                  << std::endl;
+        return 1;
+    }
+#endif
+
+    std::cout << "InstallationFinder tests passed" << std::endl;
+    return 0;
+}
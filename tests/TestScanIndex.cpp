@@ -0,0 +1,70 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "DirectoryScanner.h"
+#include "ScanIndex.h"
+#include "TemporaryDirectory.h"
+
+int main() {
+    const DosboxStagingReplacer::TemporaryDirectory temporary("TestScanIndex");
+    const auto &root = temporary.getPath();
+    const auto tree = root / "games";
+    const auto indexPath = (root / "scan.index").string();
+    std::filesystem::create_directories(tree / "doom" / "DOSBOX");
+    std::ofstream(tree / "doom" / "DOOM.EXE") << "MZ";
+    std::ofstream(tree / "doom" / "dosbox.conf") << "[sdl]";
+    std::ofstream(tree / "doom" / "DOSBOX" / "dosbox.exe") << "MZ";
+
+    std::cout << "Testing ScanIndex::save() and ScanIndex::load()" << std::endl;
+    const auto scan = DosboxStagingReplacer::DirectoryScanner::scanRecursiveCompact(
+            tree.string(), {.scan = {.readModifiedTimes = true}});
+    if (!DosboxStagingReplacer::ScanIndex::save(scan, tree.string(), indexPath)) {
+        std::cout << "ScanIndex::save() could not write the index" << std::endl;
+        return 1;
+    }
+    auto index = DosboxStagingReplacer::ScanIndex::load(indexPath, tree.string());
+    if (!index || index->size() != scan.size() || index->getDirectoryCount() != scan.getDirectoryCount()) {
+        std::cout << "ScanIndex::load() did not return the saved scan" << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < scan.size(); ++i) {
+        if ((*index)[i].path() != scan[i].path() || (*index)[i].type() != scan[i].type() ||
+            (*index)[i].size() != scan[i].size() || (*index)[i].modifiedTime() != scan[i].modifiedTime()) {
+            std::cout << "ScanIndex entry " << i << " differs from the saved scan" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Testing ScanIndex lookups" << std::endl;
+    const auto exe = index->find((tree / "doom" / "DOSBOX" / "dosbox.exe").string());
+    const auto listing = index->listDirectory((tree / "doom").string());
+    if (!exe || exe->size() != 2 || !exe->isFile() || index->find((tree / "doom" / "missing.exe").string()) ||
+        listing.size() != 3 || listing[0].name != "DOOM.EXE" || listing[1].name != "DOSBOX" ||
+        !listing[1].isDirectory() || listing[2].name != "dosbox.conf") {
+        std::cout << "ScanIndex lookups did not return the expected entries" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing ScanIndex invalidation" << std::endl;
+    if (DosboxStagingReplacer::ScanIndex::load(indexPath, (root / "other").string())) {
+        std::cout << "ScanIndex::load() accepted an index saved for another directory" << std::endl;
+        return 1;
+    }
+    // The time is moved explicitly, file systems with a coarse clock could otherwise keep the same time
+    std::ofstream(tree / "doom" / "DOSBOX" / "new.conf");
+    std::filesystem::last_write_time(tree / "doom" / "DOSBOX", std::filesystem::last_write_time(tree / "doom" / "DOSBOX") +
+                                                                     std::chrono::seconds(1));
+    if (DosboxStagingReplacer::ScanIndex::load(indexPath, tree.string())) {
+        std::cout << "ScanIndex::load() accepted an index of a directory that changed" << std::endl;
+        return 1;
+    }
+    std::filesystem::resize_file(indexPath, std::filesystem::file_size(indexPath) / 2);
+    if (DosboxStagingReplacer::ScanIndex::load(indexPath, tree.string())) {
+        std::cout << "ScanIndex::load() accepted a truncated index" << std::endl;
+        return 1;
+    }
+
+    std::cout << "ScanIndex tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "DirectoryScanner.h"
+#include "ScanResult.h"
+#include "TemporaryDirectory.h"
+
+int main() {
+    std::cout << "Testing ScanResult storage" << std::endl;
+    DosboxStagingReplacer::ScanResult result;
+    const auto games = result.addDirectory("/games/");
+    const auto doom = result.addDirectory("/games/doom/");
+    result.add(games, "doom", DosboxStagingReplacer::FileType::DIRECTORY, 0, 10);
+    result.add(doom, "DOOM.EXE", DosboxStagingReplacer::FileType::FILE, 709905, 20);
+    result.add(doom, "dosbox.conf", DosboxStagingReplacer::FileType::FILE, 120, 30);
+    const auto file = result[1].toFileEntity();
+    if (result.size() != 3 || result.getDirectoryCount() != 2 || result[0].path() != "/games/doom" ||
+        !result[0].isDirectory() || result[2].directory() != "/games/doom/" || result[2].modifiedTime() != 30 ||
+        file.name != "DOOM.EXE" || file.path != "/games/doom/DOOM.EXE" || !file.isFile() || file.size != 709905) {
+        std::cout << "ScanResult did not return the entries it was given" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing DirectoryScanner::scanRecursiveCompact()" << std::endl;
+    const DosboxStagingReplacer::TemporaryDirectory temporary("TestScanResult");
+    const auto &tree = temporary.getPath();
+    std::filesystem::create_directories(tree / "game" / "DOSBOX");
+    std::ofstream(tree / "game" / "DOSBOX" / "dosbox.exe") << "MZ";
+    std::ofstream(tree / "game" / "dosbox.conf") << "[sdl]";
+
+    // The compact scan must list exactly what scanRecursive lists, with the same order, paths and sizes
+    for (const auto &options: {DosboxStagingReplacer::RecursiveScanOptions{},
+                               DosboxStagingReplacer::RecursiveScanOptions{.scan = {.suffixes = {".conf"}}},
+                               DosboxStagingReplacer::RecursiveScanOptions{
+                                       .predicate = [](const auto &entry) { return entry.isFile(); }}}) {
+        const auto expected = DosboxStagingReplacer::DirectoryScanner::scanRecursive(tree.string(), options);
+        const auto compact =
+                DosboxStagingReplacer::DirectoryScanner::scanRecursiveCompact(tree.string(), options).toFileEntities();
+        if (!std::ranges::equal(expected, compact, [](const auto &left, const auto &right) {
+                return left.name == right.name && left.path == right.path && left.type == right.type &&
+                       left.size == right.size;
+            })) {
+            std::cout << "DirectoryScanner::scanRecursiveCompact() differs from scanRecursive()" << std::endl;
+            return 1;
+        }
+    }
+
+    const auto timed = DosboxStagingReplacer::DirectoryScanner::scanRecursiveCompact(
+            tree.string(), {.scan = {.readModifiedTimes = true}});
+    if (timed.empty() || std::ranges::any_of(timed, [](const auto &entry) { return entry.modifiedTime() <= 0; })) {
+        std::cout << "DirectoryScanner::scanRecursiveCompact() did not read the modification times" << std::endl;
+        return 1;
+    }
+
+    std::cout << "ScanResult tests passed" << std::endl;
+    return 0;
+}
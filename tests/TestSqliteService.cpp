@@ -24,6 +24,64 @@ int main () {
     }
 
     std::cout << "SqliteService::executeQuery() passed" << std::endl;
+    std::cout << "Testing SqliteSchema attributes generated from its field descriptors" << std::endl;
+
+    if (const auto attributes = result.front().getAttributes();
+        attributes.size() != 4 || std::get<0>(attributes[3]) != "rootpage" ||
+        std::get<1>(attributes[3]) != std::to_string(result.front().rootpage) ||
+        std::get<2>(attributes[3]) != DosboxStagingReplacer::DataResultDataType::Number) {
+        std::cout << "SqliteSchema::getAttributes() does not match its field descriptors" << std::endl;
+        return 1;
+    }
+
+    std::cout << "SqliteSchema attributes passed" << std::endl;
+    std::cout << "Testing SqliteService statement cache reuse" << std::endl;
+
+    const auto cachedResult = validSqlService.executeQuery<DosboxStagingReplacer::SqliteSchema>(R"SQL(
+        SELECT
+            type,
+            name,
+            tbl_name,
+            rootpage
+        FROM sqlite_schema
+    )SQL", {});
+
+    if (cachedResult.size() != result.size() || validSqlService.getStatementCacheHits() != 1 ||
+        validSqlService.getStatementCacheMisses() != 1) {
+        std::cout << "SqliteService statement cache was not reused (hits: " << validSqlService.getStatementCacheHits()
+                  << ", misses: " << validSqlService.getStatementCacheMisses() << ")" << std::endl;
+        return 1;
+    }
+
+    std::cout << "SqliteService statement cache passed" << std::endl;
+    std::cout << "Testing SqliteService::forEachRow()" << std::endl;
+
+    size_t streamedRows = 0;
+    bool streamedMatches = true;
+    validSqlService.forEachRow<DosboxStagingReplacer::SqliteSchema>(R"SQL(
+        SELECT
+            type,
+            name,
+            tbl_name,
+            rootpage
+        FROM sqlite_schema
+    )SQL", {}, [&](const DosboxStagingReplacer::SqliteSchema &row) {
+        streamedMatches = streamedMatches && row.name == result[streamedRows].name;
+        streamedRows++;
+    });
+
+    size_t stoppedRows = 0;
+    validSqlService.forEachRow<DosboxStagingReplacer::SqliteSchema>("SELECT name FROM sqlite_schema", {},
+                                                                    [&](const DosboxStagingReplacer::SqliteSchema &) {
+                                                                        return ++stoppedRows < 2;
+                                                                    });
+
+    if (streamedRows != result.size() || !streamedMatches || stoppedRows != std::min<size_t>(2, result.size())) {
+        std::cout << "SqliteService::forEachRow() did not stream the expected rows" << std::endl;
+        return 1;
+    }
+
+    std::cout << "SqliteService::forEachRow() passed" << std::endl;
     std::cout << "Testing SqliteService::executeQuery() with invalid Sqlite database" << std::endl;
 
     try {
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "TemporaryDirectory.h"
+#include "WatchedScanCache.h"
+
+int main() {
+    const DosboxStagingReplacer::TemporaryDirectory temporary("TestWatchedScanCache");
+    const auto root = temporary.getPath() / "library";
+    std::filesystem::create_directories(root / "DOSBOX");
+    std::ofstream(root / "dosbox.conf") << "[sdl]";
+
+    DosboxStagingReplacer::WatchedScanCache cache;
+    const auto names = [&] {
+        std::vector<std::string> listed;
+        for (const auto &file: *cache.scanDirectory(root.string())) {
+            listed.push_back(file.name + (file.isDirectory() ? "/" : ":" + std::to_string(file.size)));
+        }
+        return listed;
+    };
+
+    std::cout << "Testing WatchedScanCache::scanDirectory()" << std::endl;
+    const auto first = cache.scanDirectory(root.string());
+    if (names() != std::vector<std::string>{"DOSBOX/", "dosbox.conf:5"} ||
+        cache.scanDirectory(root.string()) != cache.scanDirectory(root.string())) {
+        std::cout << "WatchedScanCache::scanDirectory() did not return the directory entries" << std::endl;
+        return 1;
+    }
+
+#ifdef __linux__
+    std::cout << "Testing WatchedScanCache incremental updates" << std::endl;
+    std::ofstream(root / "game.exe") << "MZ";
+    std::ofstream(root / "dosbox.conf", std::ios::app) << "\n[dosbox]";
+    std::filesystem::rename(root / "DOSBOX", root / "dosbox-staging");
+    if (names() != std::vector<std::string>{"dosbox-staging/", "dosbox.conf:14", "game.exe:2"}) {
+        std::cout << "WatchedScanCache did not apply the creation, modification and rename" << std::endl;
+        return 1;
+    }
+    std::filesystem::remove(root / "game.exe");
+    if (names() != std::vector<std::string>{"dosbox-staging/", "dosbox.conf:14"}) {
+        std::cout << "WatchedScanCache did not apply the removal" << std::endl;
+        return 1;
+    }
+    if (cache.getScanCount() != 1 || cache.getWatchedCount() != 1) {
+        std::cout << "WatchedScanCache read the directory " << cache.getScanCount() << " times instead of once"
+                  << std::endl;
+        return 1;
+    }
+    if (first->size() != 2) {
+        std::cout << "WatchedScanCache modified a listing that was already returned" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Testing WatchedScanCache invalidation" << std::endl;
+    std::filesystem::remove_all(root);
+    try {
+        cache.scanDirectory(root.string());
+        std::cout << "WatchedScanCache returned a listing for a removed directory" << std::endl;
+        return 1;
+    } catch (const std::filesystem::filesystem_error &) {
+    }
+    if (cache.getWatchedCount() != 0) {
+        std::cout << "WatchedScanCache kept watching a removed directory" << std::endl;
+        return 1;
+    }
+#endif
+
+    std::cout << "WatchedScanCache tests passed" << std::endl;
+    return 0;
+}